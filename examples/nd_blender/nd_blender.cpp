@@ -5,10 +5,13 @@
 #include <filesystem>
 #include <fmt/format.h>
 #include <nodediff/diff.h>
+#include <nodediff/match_cache.h>
 #include <nodediff/merge.h>
+#include <nodediff/utility/arena.h>
 #include <nodediff/utility/log.h>
 #include <nodediff/utility/timer.h>
 #include <nodediff/utility/utility.h>
+#include <optional>
 
 #ifdef ND_STATISTICS_ENABLED
 #include <nodediff/utility/statistic.h>
@@ -27,10 +30,18 @@ void parse_command(args::Subparser& sp)
 		sp, "nd_out", "Output file in which to store json serialized NodeDiff script", {'o', "out"});
 	args::ValueFlag<size_t> arg_output_indent_size(sp, "indent_size", "Indentation size used for output file",
 												   {'i', "indent-size"}, 4);
+	args::Flag arg_arena(sp, "arena",
+						 "Allocate scripts and diffs from a memory arena, released at once when the command ends",
+						 {"arena"});
 
 	// Parse parameters
 	sp.Parse();
 
+	// Scripts and diffs are allocated from an arena (optional), which is released after they're destroyed
+	nd::arena arena;
+	std::optional<nd::arena_scope> arena_scope;
+	if (arg_arena) { arena_scope.emplace(arena); }
+
 	// Start a timer
 	timer timer;
 
@@ -147,18 +158,80 @@ void diff_command(args::Subparser& sp)
 		sp, "blender_vis", "Output file in which to store blender diff visualization preset", {'b', "blender-vis"});
 	args::ValueFlag<size_t> arg_output_indent_size(sp, "indent_size", "Indentation size used for output file",
 												   {'i', "indent-size"}, 4);
+	args::Flag arg_optimal_matching(sp, "optimal_matching",
+									"Match graphs and nodes optimally (assignment problem) instead of greedily",
+									{"optimal-matching"});
+	args::ValueFlag<size_t> arg_beam_width(
+		sp, "beam_width", "Match nodes by beam search, keeping the given number of best partial matchings at each step",
+		{"beam-width"});
+	args::Flag arg_structural_anchoring(sp, "structural_anchoring",
+										"Anchor nodes with a unique structural hash before matching the other nodes",
+										{"structural-anchoring"});
+	args::Flag arg_similarity_propagation(
+		sp, "similarity_propagation",
+		"Propagate matches from matched nodes to their neighbours before matching the other nodes",
+		{"similarity-propagation"});
+	args::Flag arg_spatial_candidates(
+		sp, "spatial_candidates",
+		"Compare each node with the nearest nodes of its type (by position) before comparing the other nodes",
+		{"spatial-candidates"});
+	args::Flag arg_lsh_candidates(
+		sp, "lsh_candidates",
+		"Compare each node with the nodes colliding with it in some MinHash LSH band before comparing the other nodes",
+		{"lsh-candidates"});
+	args::ValueFlag<size_t> arg_lsh_bands(sp, "lsh_bands", "Number of MinHash LSH bands (more bands, higher recall)",
+										  {"lsh-bands"}, minhash_candidates().bands);
+	args::ValueFlag<size_t> arg_lsh_rows(sp, "lsh_rows", "Number of MinHash LSH rows per band (more rows, less pairs)",
+										 {"lsh-rows"}, minhash_candidates().rows);
+	args::Flag arg_hierarchical_matching(
+		sp, "hierarchical_matching",
+		"Match frames first, then the nodes of each pair of matched frames, and finally the other nodes",
+		{"hierarchical-matching"});
+	args::Flag arg_columnar_matching(
+		sp, "columnar_matching",
+		"Compare nodes on a columnar representation of the graphs (same matches, faster on big graphs)",
+		{"columnar-matching"});
+	args::ValueFlag<size_t> arg_time_budget(
+		sp, "time_budget",
+		"Time budget (in milliseconds) for matching graphs and nodes, once expired unmatched ones are added/deleted",
+		{"time-budget"});
+	args::ValueFlag<std::string> arg_match_cache(
+		sp, "match_cache", "Directory in which to cache matches, so that diffing again the same scripts skips matching",
+		{"match-cache"});
+	args::ValueFlag<size_t> arg_match_cache_size(
+		sp, "match_cache_size", "Maximum size (in MiB) of the match cache, least recently used matches are evicted",
+		{"match-cache-size"}, match_cache::default_max_size / (1024 * 1024));
+	args::Flag arg_arena(sp, "arena",
+						 "Allocate scripts and diffs from a memory arena, released at once when the command ends",
+						 {"arena"});
 #ifdef ND_STATISTICS_ENABLED
 	args::ValueFlag<std::string> arg_statistics_output(
 		sp, "out_statistics", "Output file's path in which to store diff statistics", {'s', "stats"});
 #endif
 	sp.Parse();
 
+	// Scripts and diffs are allocated from an arena (optional), which is released after they're destroyed
+	nd::arena arena;
+	std::optional<nd::arena_scope> arena_scope;
+	if (arg_arena) { arena_scope.emplace(arena); }
+
 	// Assign to variables
 	const std::string& preset1_fp					   = arg_preset1.Get();
 	const std::string& preset2_fp					   = arg_preset2.Get();
 	const std::string& diff_output_fp				   = arg_diff_output.Get();
 	const std::string& blender_visualization_output_fp = arg_blender_visualization_output.Get();
 	const size_t& indent_size						   = arg_output_indent_size.Get();
+	const bool optimal_matching						   = arg_optimal_matching.Get();
+	const bool structural_anchoring					   = arg_structural_anchoring.Get();
+	const bool similarity_propagation				   = arg_similarity_propagation.Get();
+	const bool spatial_candidates					   = arg_spatial_candidates.Get();
+	const bool lsh_candidates						   = arg_lsh_candidates.Get();
+	const size_t lsh_bands							   = arg_lsh_bands.Get();
+	const size_t lsh_rows							   = arg_lsh_rows.Get();
+	const bool hierarchical_matching				   = arg_hierarchical_matching.Get();
+	const bool columnar_matching					   = arg_columnar_matching.Get();
+	const std::string& match_cache_dir				   = arg_match_cache.Get();
+	const size_t match_cache_size					   = arg_match_cache_size.Get();
 #ifdef ND_STATISTICS_ENABLED
 	const std::string& statistics_output_fp = arg_statistics_output.Get();
 #endif
@@ -188,17 +261,74 @@ void diff_command(args::Subparser& sp)
 
 	// Diff scripts
 #ifdef ND_STATISTICS_ENABLED
-	auto& statistic			  = nd::statistics_collector::instance();
-	statistic.json["matches"] = nd::json::array();
+	auto& statistic				  = nd::statistics_collector::instance();
+	statistic.json["matches"]	  = nd::json::array();
+	statistic.json["match_calls"] = nd::json::array();
 	auto& diff_statistics = statistic.json["diff"] = nd::json::object();
 #endif
-	script_diff script_diff = diff_scripts(script1, script2, match_graphs(script1, script2));
+	const match_engine graph_engine	 = optimal_matching ? match_engine::optimal : match_engine::scan;
+	const match_engine node_engine	 = optimal_matching ? match_engine::optimal
+									   : arg_beam_width ? match_engine::beam
+														: match_engine::heap;
+	node_candidates_fn candidates_fn = nullptr;
+	if (spatial_candidates && lsh_candidates)
+	{
+		nd_log_warning("Spatial and LSH candidates can't be used together, only spatial candidates are used");
+	}
+	if (spatial_candidates) { candidates_fn = blender::spatial_candidates(); }
+	else if (lsh_candidates) { candidates_fn = minhash_candidates{.bands = lsh_bands, .rows = lsh_rows}; }
+	const node_region_fn region_fn		  = hierarchical_matching ? node_region_fn(blender::frame_region) : nullptr;
+	const node_match_options node_options = {.engine				 = node_engine,
+											 .beam_width			 = arg_beam_width ? arg_beam_width.Get() : 1,
+											 .structural_anchoring	 = structural_anchoring,
+											 .similarity_propagation = similarity_propagation,
+											 .candidates_fn			 = candidates_fn,
+											 .region_fn				 = region_fn,
+											 .columnar				 = columnar_matching};
+	const match_budget budget =
+		arg_time_budget ? match_budget(std::chrono::milliseconds(arg_time_budget.Get())) : match_budget();
+	// Matches of the scripts are looked up in the match cache (if any); on a miss they're found while diffing, and then
+	// stored in the cache
+	script_match matches;
+	bool is_cache_hit = false;
+	std::string match_cache_key;
+	if (!match_cache_dir.empty())
+	{
+		match_cache_key = match_cache::key(
+			script1, script2,
+			fmt::format("optimal={};beam={};anchoring={};propagation={};spatial={};lsh={}x{};hierarchical={}",
+						optimal_matching, arg_beam_width ? arg_beam_width.Get() : 0, structural_anchoring,
+						similarity_propagation, spatial_candidates, lsh_candidates ? lsh_bands : 0,
+						lsh_candidates ? lsh_rows : 0, hierarchical_matching));
+		if (auto cached_matches = match_cache(match_cache_dir).load(match_cache_key))
+		{
+			matches		 = std::move(*cached_matches);
+			is_cache_hit = true;
+			nd_log("Matches loaded from match cache: " << match_cache_key);
+		}
+	}
+	if (!is_cache_hit) { matches.graph_matches = match_graphs(script1, script2, graph_engine, &budget); }
+	script_diff script_diff =
+		diff_scripts(script1, script2, matches.graph_matches, node_options, &budget, &matches.node_matches);
+	if (!match_cache_dir.empty() && !is_cache_hit && !script_diff.is_degraded)
+	{
+		if (!match_cache(match_cache_dir, match_cache_size * 1024 * 1024).store(match_cache_key, matches))
+		{
+			nd_log_warning("Matches could not be stored in match cache: " << match_cache_dir);
+		}
+	}
+	if (script_diff.is_degraded)
+	{
+		nd_log_warning("Matching time budget expired, unmatched graphs and nodes are diffed as added/deleted");
+	}
 
 	// Hack for diff-ignoring node property values
 	blender::diff_ignore_node_property_values(script_diff, {"v.x", "v.y", "v.width", "v.height", "v.width_hidden"});
 
 #ifdef ND_STATISTICS_ENABLED
-	diff_statistics["time"] = timer.milliseconds();
+	diff_statistics["time"]			   = timer.milliseconds();
+	diff_statistics["degraded"]		   = script_diff.is_degraded;
+	diff_statistics["match_cache_hit"] = is_cache_hit;
 
 	if (!statistics_output_fp.empty())
 	{
@@ -262,6 +392,9 @@ void merge_command(args::Subparser& sp)
 		sp, "blender_vis", "Output file in which to store blender merge visualization preset", {'b', "blender-vis"});
 	args::ValueFlag<size_t> arg_indent_size(sp, "indent_size", "Indentation size used for output file",
 											{'i', "indent-size"}, 4);
+	args::Flag arg_arena(sp, "arena",
+						 "Allocate scripts and diffs from a memory arena, released at once when the command ends",
+						 {"arena"});
 #ifdef ND_STATISTICS_ENABLED
 	args::ValueFlag<std::string> arg_statistics_output(
 		sp, "out_statistics", "Output file's path in which to store merge statistics", {'s', "stats"});
@@ -269,6 +402,11 @@ void merge_command(args::Subparser& sp)
 
 	sp.Parse();
 
+	// Scripts and diffs are allocated from an arena (optional), which is released after they're destroyed
+	nd::arena arena;
+	std::optional<nd::arena_scope> arena_scope;
+	if (arg_arena) { arena_scope.emplace(arena); }
+
 	// Assign to variables
 	const std::string& ancestor_fp					   = arg_ancestor.Get();
 	const std::string& version1_fp					   = arg_version1.Get();
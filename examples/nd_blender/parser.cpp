@@ -10,8 +10,8 @@ namespace nd
 namespace blender
 {
 	static node parse_blender_node(const nd::json& bl_node,
-								   const std::unordered_map<std::string, std::string>& graph_name_uuid,
-								   const std::unordered_map<int, std::string>& node_idx_uuid)
+								   const std::unordered_map<std::string, graph_ref>& graph_name_uuid,
+								   const std::unordered_map<int, node_ref>& node_idx_uuid)
 	{
 		nd::node node;
 		const std::string& bl_node_type = bl_node.at(nkit::NODE_NAME);
@@ -27,7 +27,7 @@ namespace blender
 		node_ref parent_id = node_ref::invalid_ref;
 
 		const nd::json& bl_parent_idx = bl_node.at(nkit::NODE_PARENT);
-		if (bl_parent_idx.is_number()) { parent_id.name = node_idx_uuid.at(bl_parent_idx.get<int>()); }
+		if (bl_parent_idx.is_number()) { parent_id = node_idx_uuid.at(bl_parent_idx.get<int>()); }
 		add_node_reference(node, NODE_PARENT, parent_id);
 
 		// Parse: "node_tree"
@@ -37,8 +37,8 @@ namespace blender
 		{
 			const nd::json& node_tree	  = bl_node.at(nkit::NODETREE);
 			const std::string& graph_name = node_tree.at(nkit::NODETREE_NAME);
-			graph_ref.name				  = graph_name_uuid.at(graph_name);
-			add_property_value(node, "p.group_name", value(graph_name));
+			graph_ref					  = graph_name_uuid.at(graph_name);
+			add_property_value(node, NODE_GROUP_NAME, value(graph_name));
 		}
 		add_graph_reference(node, NODE_NODEGROUP, graph_ref);
 
@@ -114,22 +114,22 @@ namespace blender
 	}
 
 	static graph parse_blender_graph(const nd::json& bl_graph,
-									 const std::unordered_map<std::string, std::string>& graph_name_uuid)
+									 const std::unordered_map<std::string, graph_ref>& graph_name_uuid)
 	{
 		nd::graph graph;
 
 		// Collect all blender nodes and assign a uuid to them
 		const std::vector<nd::json>& nodes = bl_graph.at(nkit::NODES_LIST);
-		std::unordered_map<int, std::string> node_idx_uuid = {};
+		std::unordered_map<int, node_ref> node_idx_uuid = {};
 		for (const auto& [node_idx, bl_node] : enumerate(nodes))
 		{
-			node_idx_uuid[node_idx] = nd::uuid().string();
+			node_idx_uuid[node_idx] = node_ref{.id = ref_id(nd::uuid())};
 		}
 
 		// For each node => parse it and add it to graph
 		for (const auto& [node_idx, bl_node] : enumerate(nodes))
 		{
-			nd::node_ref node_id{.name = node_idx_uuid.at(node_idx)};
+			const nd::node_ref& node_id = node_idx_uuid.at(node_idx);
 			add_node(graph, node_id, parse_blender_node(bl_node, graph_name_uuid, node_idx_uuid));
 		}
 
@@ -148,9 +148,9 @@ namespace blender
 		{
 			for (const auto& [to_socket_idx, edges] : per_socket_edges)
 			{
-				node_ref to_node_id{.name = node_idx_uuid.at(to_node_idx)};
-				nd::node& to_node	   = graph.nodes.at(to_node_id);
-				int virtual_socket_idx = 0;
+				const node_ref& to_node_id = node_idx_uuid.at(to_node_idx);
+				nd::node& to_node		   = graph.nodes.at(to_node_id);
+				int virtual_socket_idx	   = 0;
 				for (const nd::json& edge : edges)
 				{
 					const std::string& to_socket_name = edge.at(nkit::TO_SOCKET_NAME);
@@ -160,7 +160,7 @@ namespace blender
 					const std::string& from_socket_name = edge.at(nkit::FROM_SOCKET_NAME);
 					int from_socket_idx					= edge.at(nkit::FROM_SOCKET_INDEX);
 					const std::string& from_socket_id	= fmt::format("o.{}.{}", from_socket_idx, from_socket_name);
-					node_ref from_node_id{.name = node_idx_uuid.at(from_node_idx)};
+					const node_ref& from_node_id		= node_idx_uuid.at(from_node_idx);
 
 					// Handle virtual sockets
 					// If first count
@@ -195,7 +195,7 @@ namespace blender
 			add_property_value(interface_input_node, INTERFACE_INPUTS_SIZE, value(interface_inputs_size));
 			add_property_value(interface_input_node, NODE_TYPE,
 							   value(nkit::NODETREE_INTERFACE_INPUTS));
-			add_property_value(interface_input_node, "p.group_name", value(bl_graph_name));
+			add_property_value(interface_input_node, NODE_GROUP_NAME, value(bl_graph_name));
 			for (const auto& [idx, interface_inp] : bl_interface_inputs.items())
 			{
 				add_property_value(interface_input_node, fmt::format("p.{}.default", idx),
@@ -207,7 +207,7 @@ namespace blender
 				add_property_value(interface_input_node, fmt::format("p.{}.hide", idx),
 								   interface_inp.at(nkit::INTERFACE_INPUTS_HIDE).get<value>());
 			}
-			add_node(graph, node_ref{.name = nd::uuid().string()}, interface_input_node);
+			add_node(graph, node_ref{.id = ref_id(nd::uuid())}, interface_input_node);
 		}
 
 		return graph;
@@ -250,16 +250,16 @@ namespace blender
 
 		// Collect all blender graphs (i.e.nodegroups) and assign a uuid to them
 		std::unordered_map<std::string, nd::json> bl_graphs = collect_graphs(bl_script);
-		std::unordered_map<std::string, std::string> graph_name_uuid = {};
+		std::unordered_map<std::string, graph_ref> graph_name_uuid = {};
 		for (const auto& [graph_name, bl_graph] : bl_graphs)
 		{
-			graph_name_uuid[graph_name] = graph_name == "nd_Main" ? graph_name : nd::uuid().string();
+			graph_name_uuid[graph_name] = {.id = graph_name == "nd_Main" ? ref_id(graph_name) : ref_id(nd::uuid())};
 		}
 
 		// For each blender graph => parse it
 		for (const auto& [graph_name, bl_graph] : bl_graphs)
 		{
-			nd::graph_ref graph_id{.name = graph_name_uuid.at(graph_name)};
+			const nd::graph_ref& graph_id = graph_name_uuid.at(graph_name);
 			add_graph(script, graph_id, parse_blender_graph(bl_graph, graph_name_uuid));
 		}
 		return script;
@@ -356,7 +356,7 @@ namespace blender
 		bool has_counted_virtual_sockets = false;
 		for (const auto& [property_name, value] : node.node_values)
 		{
-			std::string_view property_view(property_name);
+			std::string_view property_view(property_name.name());
 			const char& property_type_char = property_view.at(0);
 			property_view.remove_prefix(2);
 			switch (property_type_char)
@@ -368,7 +368,7 @@ namespace blender
 			case 'a': { // e.g. "attrs": [{"type_name": "bool", "value": 0, "attr_name": "active_preview"}]
 				auto& res_attribute		  = node_attributes.emplace_back();
 				std::string brs_node_type = node_type == "ShaderNodeGroup" || node_type == "GeometryNodeGroup"
-												? get_property_value(node, "p.group_name").get<std::string>()
+												? get_property_value(node, NODE_GROUP_NAME).get<std::string>()
 												: node_type;
 				res_attribute[nkit::NODE_ATTRIBUTE_TYPE] =
 					brs.from_node_type.at(brs_node_type).from_attribute_name.at(property_view.data());
@@ -392,7 +392,7 @@ namespace blender
 
 		for (const auto& [property_name, value] : node.node_values)
 		{
-			std::string_view property_view(property_name);
+			std::string_view property_view(property_name.name());
 			const char& property_type_char = property_view.at(0);
 			// property_view.remove_prefix(2);
 			switch (property_type_char)
@@ -404,7 +404,7 @@ namespace blender
 				auto& res_inp = node_inputs[socket.idx];
 
 				std::string brs_node_type = node_type == "ShaderNodeGroup" || node_type == "GeometryNodeGroup"
-												? get_property_value(node, "p.group_name").get<std::string>()
+												? get_property_value(node, NODE_GROUP_NAME).get<std::string>()
 												: node_type;
 
 				res_inp[nkit::NODE_SOCKET_TYPE] = brs.from_node_type.at(brs_node_type).from_input_name.at(socket.name);
@@ -417,7 +417,7 @@ namespace blender
 					case value::type::float_number: property_type = "NodeSocketFloat"; break;
 					case value::type::int_number: property_type = "NodeSocketInt"; break;
 					case value::type::float_array: {
-						size_t array_size = value.get<std::vector<float>>().size();
+						size_t array_size = value.get<float_array>().size();
 						if (array_size == 3) { property_type = "NodeSocketVector"; }
 						else if (array_size == 4)
 						{
@@ -430,7 +430,7 @@ namespace blender
 						break;
 					}
 					case value::type::int_array: {
-						size_t array_size = value.get<std::vector<int>>().size();
+						size_t array_size = value.get<int_array>().size();
 						if (array_size == 3) { property_type = "NodeSocketVector"; }
 						else if (array_size == 4)
 						{
@@ -460,7 +460,7 @@ namespace blender
 				auto& res_out = node_outputs[socket.idx];
 
 				std::string brs_node_type = node_type == "ShaderNodeGroup" || node_type == "GeometryNodeGroup"
-												? get_property_value(node, "p.group_name").get<std::string>()
+												? get_property_value(node, NODE_GROUP_NAME).get<std::string>()
 												: node_type;
 
 				res_out[nkit::NODE_SOCKET_TYPE] = brs.from_node_type.at(brs_node_type).from_output_name.at(socket.name);
@@ -493,7 +493,7 @@ namespace blender
 				auto& interface_inputs = res[nkit::NODETREE_INTERFACE_INPUTS] = nd::json::array();
 
 				// Set NodeGroup name
-				res[nkit::NODETREE_NAME] = get_property_value(node, "p.group_name").get<std::string>();
+				res[nkit::NODETREE_NAME] = get_property_value(node, NODE_GROUP_NAME).get<std::string>();
 
 				assert(get_property_value(node, INTERFACE_INPUTS_SIZE).type() == value::type::int_number &&
 					   "invalid type, should be int");
@@ -534,7 +534,7 @@ namespace blender
 			if (group_graph_ref != graph_ref::invalid_ref)
 			{
 				auto& node_tree				   = res_node[nkit::NODETREE];
-				node_tree[nkit::NODETREE_NAME] = group_graph_ref.name;
+				node_tree[nkit::NODETREE_NAME] = group_graph_ref.name();
 				// Recursive call
 				export_nd_script(script, get_graph(script, group_graph_ref), node_tree, brs);
 			}
@@ -551,8 +551,8 @@ namespace blender
 				if (input_ref == edge::invalid_edge) continue;
 				auto& edge = links_list.emplace_back();
 
-				blender_socket from_socket = build_socket_from_string(input_ref.socket_name);
-				blender_socket to_socket   = build_socket_from_string(socketName);
+				blender_socket from_socket = build_socket_from_string(input_ref.socket_name.name());
+				blender_socket to_socket   = build_socket_from_string(socketName.name());
 
 				edge[nkit::FROM_NODE_INDEX]	  = node_id_to_idx.at(input_ref.node);
 				edge[nkit::FROM_SOCKET_INDEX] = from_socket.idx;
@@ -570,7 +570,7 @@ namespace blender
 	nd::json export_nd_script(const script& script, const preset_rebuild_structure& brs)
 	{
 		nd::json res;
-		const graph& main = get_graph(script, graph_ref{.name = MAIN_GRAPH_ID});
+		const graph& main = get_graph(script, graph_ref{.id = MAIN_GRAPH_ID});
 		export_nd_script(script, main, res, brs);
 		return res;
 	}
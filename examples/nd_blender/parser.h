@@ -1,4 +1,5 @@
 #pragma once
+#include <nodediff/symbol.h>
 #include <nodediff/utility/types.h>
 #include <unordered_map>
 
@@ -80,16 +81,18 @@ namespace blender
 	// Used for extra node properties that are not blender-default properties
 	static const std::string& NODE_PRIVATE_PREFIX = "p.";
 
-	static const std::string& NODE_TYPE			= "v.node_name";
-	static const std::string& NODE_PARENT		= "v.parent";
-	static const std::string& NODE_WIDTH		= "v.width";
-	static const std::string& NODE_HEIGHT		= "v.height";
-	static const std::string& NODE_WIDTH_HIDDEN = "v.width_hidden";
-	static const std::string& NODE_X			= "v.x";
-	static const std::string& NODE_Y			= "v.y";
-
-	static const std::string& NODE_NODEGROUP		= "p.node_group";
-	static const std::string& INTERFACE_INPUTS_SIZE = "p.size";
+	// Property names (interned once, see nd::symbol)
+	static const symbol NODE_TYPE		  = "v.node_name";
+	static const symbol NODE_PARENT		  = "v.parent";
+	static const symbol NODE_WIDTH		  = "v.width";
+	static const symbol NODE_HEIGHT		  = "v.height";
+	static const symbol NODE_WIDTH_HIDDEN = "v.width_hidden";
+	static const symbol NODE_X			  = "v.x";
+	static const symbol NODE_Y			  = "v.y";
+
+	static const symbol NODE_NODEGROUP		  = "p.node_group";
+	static const symbol NODE_GROUP_NAME		  = "p.group_name";
+	static const symbol INTERFACE_INPUTS_SIZE = "p.size";
 
 	constexpr const int MAX_NUMBER_VIRTUAL_SOCKETS = 16;
 }; // namespace blender
@@ -4,6 +4,9 @@
 
 #include <nodediff/diff.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace nd
 {
 template <>
@@ -12,7 +15,7 @@ std::string get_node_type(const node& node)
 	const std::string& node_type = get_property_value(node, blender::NODE_TYPE).get<std::string>();
 	if (node_type == "ShaderNodeGroup" || node_type == "GeometryNodeGroup")
 	{
-		return get_property_value(node, "p.group_name").get<std::string>();
+		return get_property_value(node, blender::NODE_GROUP_NAME).get<std::string>();
 	}
 	return node_type;
 }
@@ -22,7 +25,7 @@ namespace blender
 	void color_node(node& node, const color3& color)
 	{
 		add_property_value(node, "a.use_custom_color", value(1));
-		add_property_value(node, "a.color", value(std::vector<float>{color[0], color[1], color[2]}));
+		add_property_value(node, "a.color", value(float_array{color[0], color[1], color[2]}));
 	}
 
 	void apply_diff_visually(graph& graph, const graph_diff& diff, const visual_patch_color_schema& color_schema)
@@ -143,5 +146,96 @@ namespace blender
 			diff.graphs.erase(graph_id);
 		}
 	}
+
+	/*
+	 * Position of a Blender node, namely its x and y values. It returns false if the node has no position.
+	 */
+	static bool node_position(const node& node, std::array<float, 2>& position)
+	{
+		const std::array<const symbol*, 2> axes = {&NODE_X, &NODE_Y};
+		for (size_t axis = 0; axis < axes.size(); ++axis)
+		{
+			auto value = node.node_values.find(*axes[axis]);
+			if (value == node.node_values.end()) { return false; }
+			if (value->second.type() == value::type::float_number) { position[axis] = value->second.get<float>(); }
+			else if (value->second.type() == value::type::int_number)
+			{
+				position[axis] = static_cast<float>(value->second.get<int>());
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	match_candidates<node_ref> spatial_candidates::operator()(const graph& ancestor, const graph& version) const
+	{
+		// Uniform grid (for each node type) over ancestor nodes' positions, with cells of size max_distance: ancestor
+		// nodes within max_distance from a position are in its cell or in the 8 cells around it
+		using grid_cell = std::vector<std::pair<std::array<float, 2>, node_ref>>;
+		std::unordered_map<std::string, std::unordered_map<int64_t, grid_cell>> grids;
+		auto cell_coordinate = [&](float coordinate) -> int64_t {
+			return static_cast<int64_t>(std::floor(coordinate / max_distance));
+		};
+		auto cell_key = [](int64_t cell_x, int64_t cell_y) -> int64_t {
+			return (cell_x << 32) ^ (cell_y & 0xffffffff);
+		};
+		std::array<float, 2> position;
+		for (const auto& [node_id, node] : ancestor.nodes)
+		{
+			if (!node_position(node, position)) { continue; }
+			grids[get_node_type(node)][cell_key(cell_coordinate(position[0]), cell_coordinate(position[1]))]
+				.emplace_back(position, node_id);
+		}
+
+		match_candidates<node_ref> candidates;
+		// <squared distance, ancestor node id> pairs of the ancestor nodes within max_distance
+		std::vector<std::pair<float, node_ref>> nearest;
+		for (const auto& [node_id, node] : version.nodes)
+		{
+			auto grid = grids.find(get_node_type(node));
+			if (grid == grids.end() || !node_position(node, position)) { continue; }
+
+			nearest.clear();
+			const int64_t cell_x = cell_coordinate(position[0]), cell_y = cell_coordinate(position[1]);
+			for (int64_t neighbour_x = cell_x - 1; neighbour_x <= cell_x + 1; ++neighbour_x)
+			{
+				for (int64_t neighbour_y = cell_y - 1; neighbour_y <= cell_y + 1; ++neighbour_y)
+				{
+					auto cell = grid->second.find(cell_key(neighbour_x, neighbour_y));
+					if (cell == grid->second.end()) { continue; }
+					for (const auto& [ancestor_position, ancestor_id] : cell->second)
+					{
+						const float dx = ancestor_position[0] - position[0], dy = ancestor_position[1] - position[1];
+						const float squared_distance = dx * dx + dy * dy;
+						if (squared_distance <= max_distance * max_distance)
+						{
+							nearest.emplace_back(squared_distance, ancestor_id);
+						}
+					}
+				}
+			}
+			// No ancestor node nearby ==> the version node is compared with all the ancestor nodes
+			if (nearest.empty()) { continue; }
+
+			const size_t nearest_size = std::min(k, nearest.size());
+			std::partial_sort(nearest.begin(), nearest.begin() + nearest_size, nearest.end());
+			std::vector<node_ref>& node_candidates = candidates[node_id];
+			node_candidates.reserve(nearest_size);
+			for (size_t i = 0; i < nearest_size; ++i)
+			{
+				node_candidates.push_back(nearest[i].second);
+			}
+		}
+		return candidates;
+	}
+
+	node_ref frame_region(const node& node)
+	{
+		auto parent = node.node_references.find(NODE_PARENT);
+		return parent != node.node_references.end() ? parent->second : node_ref::invalid_ref;
+	}
 }; // namespace blender
 }; // namespace nd
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <array>
 #include <nodediff/diff.h>
+#include <nodediff/matching.h>
 // Forward decl.
 namespace nd
 {
@@ -37,5 +38,25 @@ namespace blender
 	void diff_ignore_node_property_values(node_diff& diff, const std::unordered_set<std::string>& ignores);
 	void diff_ignore_node_property_values(graph_diff& diff, const std::unordered_set<std::string>& ignores);
 	void diff_ignore_node_property_values(script_diff& diff, const std::unordered_set<std::string>& ignores);
+
+	/*
+	 * Candidate pruning plugin for node matching (see nd::node_match_options) based on Blender nodes' positions: each
+	 * version node is compared only with the k nearest ancestor nodes of its type within max_distance, found through
+	 * a uniform grid over ancestor nodes' positions. Version nodes without ancestor nodes of their type within
+	 * max_distance are compared with all the ancestor nodes.
+	 */
+	struct spatial_candidates
+	{
+		size_t k		   = 8;
+		float max_distance = 1500.0f;
+
+		match_candidates<node_ref> operator()(const graph& ancestor, const graph& version) const;
+	};
+
+	/*
+	 * Region function for hierarchical node matching (see nd::node_match_options): the region of a Blender node is
+	 * the frame enclosing it (i.e. its parent node).
+	 */
+	node_ref frame_region(const node& node);
 }; // namespace blender
 }; // namespace nd
\ No newline at end of file
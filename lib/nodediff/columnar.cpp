@@ -0,0 +1,261 @@
+#include "columnar.h"
+
+#include "utility/utility.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+///
+/// Schema functionalities
+///
+namespace nd
+{
+size_t node_schema::size() const
+{
+	return node_values.size() + node_references.size() + graph_references.size() + texture_references.size() +
+		   input_references.size();
+}
+
+bool node_schema::conforms(const node& node) const
+{
+	auto conforms_to = [](const std::vector<symbol>& columns, const auto& properties) {
+		return columns.size() == properties.size() &&
+			   std::all_of(columns.begin(), columns.end(),
+						   [&](const symbol& property_name) { return properties.contains(property_name); });
+	};
+	return conforms_to(node_values, node.node_values) && conforms_to(node_references, node.node_references) &&
+		   conforms_to(graph_references, node.graph_references) &&
+		   conforms_to(texture_references, node.texture_references) &&
+		   conforms_to(input_references, node.input_references);
+}
+
+node_schemas make_node_schemas(const graph& ancestor, const graph& version)
+{
+	// Union of the property names of the nodes of each type
+	struct property_names
+	{
+		std::unordered_set<symbol> node_values, node_references, graph_references, texture_references,
+			input_references;
+	};
+	node_schemas schemas;
+	std::vector<property_names> names;
+	auto add_names = [](std::unordered_set<symbol>& names, const auto& properties) {
+		for (const auto& [property_name, property] : properties)
+		{
+			names.insert(property_name);
+		}
+	};
+	for (const graph* graph : {&ancestor, &version})
+	{
+		for (const auto& [node_id, node] : graph->nodes)
+		{
+			auto [it, inserted] = schemas.type_index.try_emplace(get_node_type(node), schemas.schemas.size());
+			if (inserted)
+			{
+				schemas.schemas.push_back({.type = it->first});
+				names.emplace_back();
+			}
+			property_names& type_names = names[it->second];
+			add_names(type_names.node_values, node.node_values);
+			add_names(type_names.node_references, node.node_references);
+			add_names(type_names.graph_references, node.graph_references);
+			add_names(type_names.texture_references, node.texture_references);
+			add_names(type_names.input_references, node.input_references);
+		}
+	}
+
+	// Columns are sorted by property name, so that schemas do not depend on the order of the nodes
+	auto make_columns = [](const std::unordered_set<symbol>& names) {
+		std::vector<symbol> columns(names.begin(), names.end());
+		std::sort(columns.begin(), columns.end(),
+				  [](const symbol& a, const symbol& b) { return a.name() < b.name(); });
+		return columns;
+	};
+	for (size_t type_idx = 0; type_idx < schemas.schemas.size(); ++type_idx)
+	{
+		node_schema& schema		  = schemas.schemas[type_idx];
+		schema.node_values		  = make_columns(names[type_idx].node_values);
+		schema.node_references	  = make_columns(names[type_idx].node_references);
+		schema.graph_references	  = make_columns(names[type_idx].graph_references);
+		schema.texture_references = make_columns(names[type_idx].texture_references);
+		schema.input_references	  = make_columns(names[type_idx].input_references);
+	}
+	return schemas;
+}
+}; // namespace nd
+
+///
+/// Columnar graph functionalities
+///
+namespace nd
+{
+template <typename PropertyType>
+static std::span<const PropertyType> row_span(const std::vector<PropertyType>& column_values, size_t columns,
+											  uint32_t row)
+{
+	return {column_values.data() + row * columns, columns};
+}
+
+std::span<const value> columnar_node::node_values() const
+{
+	return row_span(table->node_values, schema->node_values.size(), row);
+}
+std::span<const node_ref> columnar_node::node_references() const
+{
+	return row_span(table->node_references, schema->node_references.size(), row);
+}
+std::span<const graph_ref> columnar_node::graph_references() const
+{
+	return row_span(table->graph_references, schema->graph_references.size(), row);
+}
+std::span<const texture_ref> columnar_node::texture_references() const
+{
+	return row_span(table->texture_references, schema->texture_references.size(), row);
+}
+std::span<const edge> columnar_node::input_references() const
+{
+	return row_span(table->input_references, schema->input_references.size(), row);
+}
+
+columnar_graph make_columnar_graph(const graph& graph, const node_schemas& schemas)
+{
+	columnar_graph columnar;
+	columnar.tables.resize(schemas.schemas.size());
+	columnar.nodes.reserve(graph.nodes.size());
+
+	// Count the rows of each table first, so that tables are allocated once
+	std::vector<uint32_t> type_of_node;
+	std::vector<bool> is_conforming;
+	type_of_node.reserve(graph.nodes.size());
+	is_conforming.reserve(graph.nodes.size());
+	for (const auto& [node_id, node] : graph.nodes)
+	{
+		const uint32_t type_idx = schemas.type_index.at(get_node_type(node));
+		type_of_node.push_back(type_idx);
+		is_conforming.push_back(schemas.schemas[type_idx].conforms(node));
+		if (is_conforming.back()) { ++columnar.tables[type_idx].rows; }
+	}
+	for (size_t type_idx = 0; type_idx < schemas.schemas.size(); ++type_idx)
+	{
+		const node_schema& schema = schemas.schemas[type_idx];
+		node_table& table		  = columnar.tables[type_idx];
+		table.node_values.reserve(table.rows * schema.node_values.size());
+		table.node_references.reserve(table.rows * schema.node_references.size());
+		table.graph_references.reserve(table.rows * schema.graph_references.size());
+		table.texture_references.reserve(table.rows * schema.texture_references.size());
+		table.input_references.reserve(table.rows * schema.input_references.size());
+		table.rows = 0;
+	}
+
+	// Append the row of each conforming node, its properties in the order of the schema's columns
+	auto append_row = [](auto& column_values, const std::vector<symbol>& columns, const auto& properties) {
+		for (const symbol& property_name : columns)
+		{
+			column_values.push_back(properties.at(property_name));
+		}
+	};
+	size_t node_idx = 0;
+	for (const auto& [node_id, node] : graph.nodes)
+	{
+		const size_t idx		  = node_idx++;
+		const uint32_t type_idx	  = type_of_node[idx];
+		const node_schema& schema = schemas.schemas[type_idx];
+		node_table& table		  = columnar.tables[type_idx];
+		columnar_node& row		  = columnar.nodes[node_id];
+		row.node				  = &node;
+		row.schema				  = &schema;
+		row.table				  = &table;
+		if (!is_conforming[idx]) { continue; }
+
+		append_row(table.node_values, schema.node_values, node.node_values);
+		append_row(table.node_references, schema.node_references, node.node_references);
+		append_row(table.graph_references, schema.graph_references, node.graph_references);
+		append_row(table.texture_references, schema.texture_references, node.texture_references);
+		append_row(table.input_references, schema.input_references, node.input_references);
+		row.row = table.rows++;
+	}
+	return columnar;
+}
+}; // namespace nd
+
+///
+/// Functions for diffing rows' properties
+///
+namespace nd
+{
+int diff_node_values(const columnar_node& ancestor_node, const columnar_node& version_node)
+{
+	const std::span<const value> ancestor_values = ancestor_node.node_values();
+	const std::span<const value> version_values	 = version_node.node_values();
+	int count									 = 0;
+	for (size_t column = 0; column < version_values.size(); ++column)
+	{
+		count += ancestor_values[column] != version_values[column];
+	}
+	return count;
+}
+
+int diff_node_references(const columnar_node& ancestor_node, const columnar_node& version_node,
+						 const ref_match<node_ref>& node_matches)
+{
+	const std::span<const node_ref> ancestor_refs = ancestor_node.node_references();
+	const std::span<const node_ref> version_refs  = version_node.node_references();
+	int count									  = 0;
+	for (size_t column = 0; column < version_refs.size(); ++column)
+	{
+		// A reference to a node added in version is always a diff (see nd::diff_node_references)
+		count += !node_matches.has_match_in_ancestor(version_refs[column]) ||
+				 node_matches.to_ancestor(version_refs[column]) != ancestor_refs[column];
+	}
+	return count;
+}
+
+int diff_graph_references(const columnar_node& ancestor_node, const columnar_node& version_node,
+						  const ref_match<graph_ref>& graph_matches)
+{
+	const std::span<const graph_ref> ancestor_refs = ancestor_node.graph_references();
+	const std::span<const graph_ref> version_refs  = version_node.graph_references();
+	int count									   = 0;
+	for (size_t column = 0; column < version_refs.size(); ++column)
+	{
+		// A reference to a graph added in version is always a diff (see nd::diff_graph_references)
+		count += !graph_matches.has_match_in_ancestor(version_refs[column]) ||
+				 graph_matches.to_ancestor(version_refs[column]) != ancestor_refs[column];
+	}
+	return count;
+}
+
+int diff_texture_references(const columnar_node& ancestor_node, const columnar_node& version_node)
+{
+	const std::span<const texture_ref> ancestor_refs = ancestor_node.texture_references();
+	const std::span<const texture_ref> version_refs	 = version_node.texture_references();
+	int count										 = 0;
+	for (size_t column = 0; column < version_refs.size(); ++column)
+	{
+		count += ancestor_refs[column] != version_refs[column];
+	}
+	return count;
+}
+
+int diff_input_references(const columnar_node& ancestor_node, const columnar_node& version_node,
+						  const ref_match<node_ref>& node_matches)
+{
+	const std::span<const edge> ancestor_edges = ancestor_node.input_references();
+	const std::span<const edge> version_edges  = version_node.input_references();
+	int count								   = 0;
+	for (size_t column = 0; column < version_edges.size(); ++column)
+	{
+		// An edge from a node added in version is always a diff (see nd::diff_input_references)
+		const edge& version_edge = version_edges[column];
+		if (!node_matches.has_match_in_ancestor(version_edge.node))
+		{
+			++count;
+			continue;
+		}
+		const edge match_version_edge{.node		   = node_matches.to_ancestor(version_edge.node),
+									  .socket_name = version_edge.socket_name};
+		count += ancestor_edges[column] != match_version_edge;
+	}
+	return count;
+}
+}; // namespace nd
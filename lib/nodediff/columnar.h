@@ -0,0 +1,121 @@
+#pragma once
+#include "matching.h"
+#include "script.h"
+
+#include <limits>
+#include <span>
+
+///
+/// Data structures
+///
+namespace nd
+{
+/*
+ * Schema of the nodes of a type: the names of their properties, where the position of a property name is the index of
+ * its column (see nd::node_table). Since nodes of the same type have the same set of properties (see nd::node), nodes of
+ * a type are stored as rows of a table whose columns are given by its schema.
+ */
+struct node_schema
+{
+	std::string type					   = "";
+	std::vector<symbol> node_values		   = {};
+	std::vector<symbol> node_references	   = {};
+	std::vector<symbol> graph_references   = {};
+	std::vector<symbol> texture_references = {};
+	std::vector<symbol> input_references   = {};
+
+	// Number of properties (i.e. of columns)
+	[[nodiscard]] size_t size() const;
+	// Returns true if the node has exactly the properties of the schema
+	[[nodiscard]] bool conforms(const node& node) const;
+};
+
+/*
+ * Schemas of the node types of a pair of graphs (namely an ancestor and a version graph). They're shared by the
+ * columnar representations of both graphs, so that the columns of ancestor and version nodes of the same type are
+ * index-aligned.
+ */
+struct node_schemas
+{
+	std::vector<node_schema> schemas					 = {};
+	std::unordered_map<std::string, uint32_t> type_index = {};
+};
+
+/*
+ * Table of the nodes of a type in a graph: each kind of property is stored in its own dense array, whose rows (one for
+ * each node) are stored contiguously, i.e. node_values[row * schema.node_values.size() + column].
+ * Note: rows are contiguous (rather than columns) since edit costs compare a pair of rows at a time.
+ */
+struct node_table
+{
+	uint32_t rows								= 0;
+	std::vector<value> node_values				= {};
+	std::vector<node_ref> node_references		= {};
+	std::vector<graph_ref> graph_references		= {};
+	std::vector<texture_ref> texture_references = {};
+	std::vector<edge> input_references			= {};
+};
+
+/*
+ * A node of a columnar graph: the node itself, its schema and its row in the table of its type. Nodes not conforming to
+ * the schema of their type (see nd::node_schema::conforms) have no row, their properties are only stored by the node.
+ */
+struct columnar_node
+{
+	static constexpr uint32_t no_row = std::numeric_limits<uint32_t>::max();
+
+	const nd::node* node	  = nullptr;
+	const node_schema* schema = nullptr;
+	const node_table* table	  = nullptr;
+	uint32_t row			  = no_row;
+
+	[[nodiscard]] bool has_row() const { return row != no_row; }
+	// Row's properties (the node must have a row)
+	[[nodiscard]] std::span<const value> node_values() const;
+	[[nodiscard]] std::span<const node_ref> node_references() const;
+	[[nodiscard]] std::span<const graph_ref> graph_references() const;
+	[[nodiscard]] std::span<const texture_ref> texture_references() const;
+	[[nodiscard]] std::span<const edge> input_references() const;
+};
+
+/*
+ * Columnar representation of a graph: the tables of its node types (indexed as the schemas, see nd::node_schemas) and
+ * its nodes, which refer to the graph's nodes and to the tables (hence the graph must outlive it).
+ */
+struct columnar_graph
+{
+	std::vector<node_table> tables					  = {};
+	std::unordered_map<node_ref, columnar_node> nodes = {};
+};
+}; // namespace nd
+
+///
+/// Columnar representation functionalities
+///
+namespace nd
+{
+/*
+ * Returns the schemas of the node types of the ancestor and version graphs. The properties of a type are the union of
+ * the properties of its nodes, sorted by name.
+ */
+[[nodiscard]] node_schemas make_node_schemas(const graph& ancestor, const graph& version);
+/*
+ * Returns the columnar representation of the graph, given the schemas of its node types (see nd::make_node_schemas).
+ */
+[[nodiscard]] columnar_graph make_columnar_graph(const graph& graph, const node_schemas& schemas);
+
+/*
+ * Diff functions of the rows of an ancestor and a version node with the same schema, equivalent to the diff functions
+ * of nodes (see nd::diff_node_values): they loop over the index-aligned columns of the rows.
+ *
+ * Returns: the number of properties that are different between ancestor and version.
+ */
+int diff_node_values(const columnar_node& ancestor_node, const columnar_node& version_node);
+int diff_node_references(const columnar_node& ancestor_node, const columnar_node& version_node,
+						 const ref_match<node_ref>& node_matches);
+int diff_graph_references(const columnar_node& ancestor_node, const columnar_node& version_node,
+						  const ref_match<graph_ref>& graph_matches);
+int diff_texture_references(const columnar_node& ancestor_node, const columnar_node& version_node);
+int diff_input_references(const columnar_node& ancestor_node, const columnar_node& version_node,
+						  const ref_match<node_ref>& node_matches);
+}; // namespace nd
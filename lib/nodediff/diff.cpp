@@ -3,6 +3,7 @@
 #include "script.h"
 #include "utility/utility.h"
 
+#include <algorithm>
 #include <execution>
 
 ///
@@ -291,9 +292,26 @@ graph_diff diff_graphs(const graph& ancestor, const graph& version, const ref_ma
 }
 
 // Scripts
-script_diff diff_scripts(const script& ancestor, const script& version, const ref_match<graph_ref>& graph_matches)
+script_diff diff_scripts(const script& ancestor, const script& version, const ref_match<graph_ref>& graph_matches,
+						 const node_match_options& node_options, const match_budget* budget,
+						 graph_node_matches* node_matches)
 {
+	// Once graphs are matched, the nodes of each matched graph pair can be matched and diffed independently
+	struct graph_pair_diff
+	{
+		const graph_ref* ancestor_id;
+		const graph* ancestor_graph;
+		const graph* version_graph;
+		// Node matches known before diffing (nullptr if nodes must be matched)
+		const ref_match<node_ref>* known_node_matches = nullptr;
+		ref_match<node_ref> node_matches			  = {};
+		graph_change change							  = {};
+		bool is_degraded							  = false;
+	};
+
 	script_diff diff;
+	diff.is_degraded = graph_matches.is_degraded();
+	std::vector<graph_pair_diff> graph_pair_diffs;
 	for (const auto& [version_id, version_graph] : version.graphs)
 	{
 		// If version_graph is not in the rename map ==> add
@@ -305,14 +323,51 @@ script_diff diff_scripts(const script& ancestor, const script& version, const re
 		}
 
 		// Otherwise COULD be an "edit"
-		const graph_ref& matched_version_id		= graph_matches.to_ancestor(version_id);
-		const graph& ancestor_graph				= ancestor.graphs.at(matched_version_id);
-		const ref_match<node_ref>& node_matches = match_nodes(ancestor_graph, version_graph, graph_matches);
-		// Find differences between graphs
-		graph_change graph_change{.op	= diff_operation::edit,
-								  .diff = diff_graphs(ancestor_graph, version_graph, node_matches, graph_matches)};
+		const graph_ref& matched_version_id = graph_matches.to_ancestor(version_id);
+		graph_pair_diffs.push_back({.ancestor_id	= &matched_version_id,
+									.ancestor_graph = &ancestor.graphs.at(matched_version_id),
+									.version_graph	= &version_graph});
+		if (node_matches != nullptr && node_matches->contains(matched_version_id))
+		{
+			graph_pair_diffs.back().known_node_matches = &node_matches->at(matched_version_id);
+		}
+	}
 
-		if (!is_empty(graph_change.diff)) { diff.graphs[matched_version_id] = graph_change; }
+	auto diff_graph_pair = [&](graph_pair_diff& graph_pair_diff) {
+		const graph& ancestor_graph				= *graph_pair_diff.ancestor_graph;
+		const graph& version_graph				= *graph_pair_diff.version_graph;
+		if (graph_pair_diff.known_node_matches == nullptr)
+		{
+			graph_pair_diff.node_matches =
+				match_nodes(ancestor_graph, version_graph, graph_matches, node_options, budget);
+		}
+		const ref_match<node_ref>& pair_node_matches = graph_pair_diff.known_node_matches != nullptr
+														   ? *graph_pair_diff.known_node_matches
+														   : graph_pair_diff.node_matches;
+		// Find differences between graphs
+		graph_pair_diff.change		= graph_change{.op	 = diff_operation::edit,
+												   .diff = diff_graphs(ancestor_graph, version_graph, pair_node_matches,
+																	   graph_matches)};
+		graph_pair_diff.is_degraded = pair_node_matches.is_degraded();
+	};
+#if defined(ND_PARALLELIZE)
+	std::for_each(std::execution::par, graph_pair_diffs.begin(), graph_pair_diffs.end(), diff_graph_pair);
+#else
+	std::for_each(graph_pair_diffs.begin(), graph_pair_diffs.end(), diff_graph_pair);
+#endif
+
+	// Note: graph changes are merged in the same order they would have been found sequentially
+	for (graph_pair_diff& graph_pair_diff : graph_pair_diffs)
+	{
+		diff.is_degraded = diff.is_degraded || graph_pair_diff.is_degraded;
+		if (node_matches != nullptr && graph_pair_diff.known_node_matches == nullptr)
+		{
+			node_matches->emplace(*graph_pair_diff.ancestor_id, std::move(graph_pair_diff.node_matches));
+		}
+		if (!is_empty(graph_pair_diff.change.diff))
+		{
+			diff.graphs[*graph_pair_diff.ancestor_id] = std::move(graph_pair_diff.change);
+		}
 	}
 
 	for (const auto& [ancestor_id, ancestor_graph] : ancestor.graphs)
@@ -433,14 +488,14 @@ void adl_serializer<graph_diff>::to_json(nd::json& j, const graph_diff& graph_di
 	j = nd::json::object();
 	for (const auto& [node_id, node_change] : graph_diff.nodes)
 	{
-		j[node_id.name] = node_change;
+		j[node_id.name()] = node_change;
 	}
 }
 void adl_serializer<graph_diff>::from_json(const nd::json& j, graph_diff& graph_diff)
 {
 	for (const auto& [node_id, node_change] : j.items())
 	{
-		graph_diff.nodes[node_ref{.name = node_id}] = node_change;
+		graph_diff.nodes[node_ref{.id = node_id}] = node_change;
 	}
 }
 
@@ -472,14 +527,14 @@ void adl_serializer<script_diff>::to_json(nd::json& j, const script_diff& script
 	j = nd::json::object();
 	for (const auto& [graph_id, graph_change] : script_diff.graphs)
 	{
-		j[graph_id.name] = graph_change;
+		j[graph_id.name()] = graph_change;
 	}
 }
 void adl_serializer<script_diff>::from_json(const nd::json& j, script_diff& script_diff)
 {
 	for (const auto& [graph_id, graph_change] : j.items())
 	{
-		script_diff.graphs[graph_ref{.name = graph_id}] = graph_change;
+		script_diff.graphs[graph_ref{.id = graph_id}] = graph_change;
 	}
 }
 } // namespace nlohmann
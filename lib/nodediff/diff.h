@@ -45,7 +45,7 @@ struct node_change
  */
 struct graph_diff
 {
-	std::unordered_map<node_ref, node_change> nodes = {};
+	std::pmr::unordered_map<node_ref, node_change> nodes = {};
 };
 
 /*
@@ -64,10 +64,13 @@ struct graph_change
 /*
  * A graph_diff is modeled as a collection of graph_change(s), to each of which it's associated the identifier of the
  * graph subject to that change.
+ * If the matching budget expired while diffing (see nd::match_budget), script_diff::is_degraded is true: some graphs
+ * or nodes could have been diffed as added/deleted instead of edited. Note: it is not serialized.
  */
 struct script_diff
 {
-	std::unordered_map<graph_ref, graph_change> graphs = {};
+	std::pmr::unordered_map<graph_ref, graph_change> graphs = {};
+	bool is_degraded										= false;
 };
 }; // namespace nd
 
@@ -209,10 +212,18 @@ namespace nd
  *	- ancestor: ancestor script
  *	- version: version script
  *	- graph_matches: bidirectional map of matched graphs
+ *	- node_options: options for matching the nodes of matched graphs (see nd::node_match_options)
+ *	- budget: budget for matching the nodes of matched graphs (see nd::match_budget), nullptr if there's no budget
+ *	- node_matches: node matches of matched graphs (see nd::graph_node_matches). Graph pairs whose node matches are in
+ *					the map reuse them instead of matching nodes, while the node matches found for the other pairs are
+ *					stored in the map. If it is nullptr, nodes of all the graph pairs are matched.
  * Returns: the diff between ancestor and version scripts
  */
 [[nodiscard]] script_diff diff_scripts(const script& ancestor, const script& version,
-									   const ref_match<graph_ref>& graph_matches);
+									   const ref_match<graph_ref>& graph_matches,
+									   const node_match_options& node_options = {},
+									   const match_budget* budget = nullptr,
+									   graph_node_matches* node_matches = nullptr);
 }; // namespace nd
 
 ///
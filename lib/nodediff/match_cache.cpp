@@ -0,0 +1,155 @@
+#include "match_cache.h"
+
+#include "script.h"
+#include "utility/utility.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace nd
+{
+// Version of the entries' format, part of the keys so that entries in an old format are never loaded
+constexpr int match_cache_format_version = 1;
+
+/*
+ * FNV-1a hash of a string. Unlike std::hash, its value does not depend on the standard library implementation, hence
+ * it can be used for naming persistent entries.
+ */
+static uint64_t content_hash(const std::string& content)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (unsigned char c : content)
+	{
+		hash ^= c;
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+// Serialize matches as an array of <ancestor, version> pairs
+template <typename RefType>
+static nd::json matches_to_json(const ref_match<RefType>& matches)
+{
+	nd::json j = nd::json::array();
+	for (const auto& [ancestor_id, version_id] : matches.ancestor_to_version())
+	{
+		j.push_back({ancestor_id, version_id});
+	}
+	return j;
+}
+template <typename RefType>
+static ref_match<RefType> matches_from_json(const nd::json& j)
+{
+	ref_match<RefType> matches;
+	for (const nd::json& match : j)
+	{
+		matches.add_match(match.at(0).get<RefType>(), match.at(1).get<RefType>());
+	}
+	return matches;
+}
+
+match_cache::match_cache(std::filesystem::path directory, uintmax_t max_size)
+	: m_directory(std::move(directory)), m_max_size(max_size)
+{
+}
+
+std::string match_cache::key(const script& ancestor, const script& version, const std::string& options)
+{
+	char key[3 * 16 + 3];
+	std::snprintf(key, sizeof(key), "%016llx_%016llx_%016llx",
+				  static_cast<unsigned long long>(content_hash(nd::json(ancestor).dump())),
+				  static_cast<unsigned long long>(content_hash(nd::json(version).dump())),
+				  static_cast<unsigned long long>(
+					  content_hash(std::to_string(match_cache_format_version) + ":" + options)));
+	return key;
+}
+
+std::optional<script_match> match_cache::load(const std::string& key) const
+{
+	const std::filesystem::path entry_path = m_directory / (key + ".json");
+	std::error_code error;
+	if (!std::filesystem::is_regular_file(entry_path, error)) { return std::nullopt; }
+
+	nd::json entry;
+	try
+	{
+		if (!load_json(entry_path.string(), entry)) { return std::nullopt; }
+		script_match matches = {.graph_matches = matches_from_json<graph_ref>(entry.at("graph_matches"))};
+		for (const auto& [ancestor_id, node_matches] : entry.at("node_matches").items())
+		{
+			matches.node_matches.emplace(graph_ref{ancestor_id}, matches_from_json<node_ref>(node_matches));
+		}
+		// Loaded entry is the most recently used one
+		std::filesystem::last_write_time(entry_path, std::filesystem::file_time_type::clock::now(), error);
+		return matches;
+	}
+	catch (const nd::json::exception&)
+	{
+		// Corrupted entry (e.g. partially written by a crashed process)
+		std::filesystem::remove(entry_path, error);
+		return std::nullopt;
+	}
+}
+
+bool match_cache::store(const std::string& key, const script_match& matches) const
+{
+	if (matches.graph_matches.is_degraded()) { return false; }
+	nd::json entry;
+	entry["graph_matches"] = matches_to_json(matches.graph_matches);
+	entry["node_matches"]  = nd::json::object();
+	for (const auto& [ancestor_id, node_matches] : matches.node_matches)
+	{
+		if (node_matches.is_degraded()) { return false; }
+		entry["node_matches"][ancestor_id.name()] = matches_to_json(node_matches);
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(m_directory, error);
+	if (error) { return false; }
+	// Note: the entry is written to a temporary file and then renamed, so that other processes sharing the cache never
+	// load a partially written entry
+	const std::filesystem::path entry_path = m_directory / (key + ".json");
+	const std::filesystem::path temp_path  = m_directory / (key + ".json.tmp");
+	if (!save_json(entry, temp_path.string(), -1)) { return false; }
+	std::filesystem::rename(temp_path, entry_path, error);
+	if (error)
+	{
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+
+	evict();
+	return true;
+}
+
+void match_cache::evict() const
+{
+	struct cache_entry
+	{
+		std::filesystem::path path;
+		std::filesystem::file_time_type last_use;
+		uintmax_t size;
+	};
+	std::vector<cache_entry> entries;
+	uintmax_t total_size = 0;
+	std::error_code error;
+	for (const auto& file : std::filesystem::directory_iterator(m_directory, error))
+	{
+		if (!file.is_regular_file(error) || file.path().extension() != ".json") { continue; }
+		entries.push_back(
+			{.path = file.path(), .last_use = file.last_write_time(error), .size = file.file_size(error)});
+		total_size += entries.back().size;
+	}
+	if (total_size <= m_max_size) { return; }
+
+	// Evict least recently used entries first
+	std::sort(entries.begin(), entries.end(),
+			  [](const cache_entry& e1, const cache_entry& e2) { return e1.last_use < e2.last_use; });
+	for (const cache_entry& entry : entries)
+	{
+		if (total_size <= m_max_size) { break; }
+		if (std::filesystem::remove(entry.path, error)) { total_size -= entry.size; }
+	}
+}
+}; // namespace nd
@@ -0,0 +1,65 @@
+#pragma once
+#include "matching.h"
+#include "reference.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+// Forward declarations
+namespace nd
+{
+struct script;
+}; // namespace nd
+
+///
+/// Data structures
+///
+namespace nd
+{
+/*
+ * All the matches found when diffing two scripts: the graph matches, and the node matches of each matched graph pair
+ * (see nd::graph_node_matches).
+ */
+struct script_match
+{
+	ref_match<graph_ref> graph_matches = {};
+	graph_node_matches node_matches	   = {};
+};
+
+/*
+ * Persistent on-disk cache of script matches, so that diffing again the same pair of scripts skips matching.
+ * Each entry is a json file stored in the cache directory, named after its key (see match_cache::key). Once the total
+ * size of the entries exceeds the maximum size, the least recently used ones (i.e. the ones stored or loaded least
+ * recently) are evicted.
+ * Note: degraded matches (see nd::match_budget) are never stored, since they depend on the time taken by matching.
+ */
+class match_cache
+{
+  public:
+	// Default maximum size of the cache (in bytes)
+	static constexpr uintmax_t default_max_size = 64 * 1024 * 1024;
+
+	explicit match_cache(std::filesystem::path directory, uintmax_t max_size = default_max_size);
+
+	/*
+	 * Key of the matches of two scripts: the content hashes of the ancestor and version scripts, and the hash of the
+	 * matching options (any string identifying the options the matches depend on, e.g. the engines used).
+	 */
+	[[nodiscard]] static std::string key(const script& ancestor, const script& version, const std::string& options);
+
+	// Load the matches stored with the given key, if any (the entry becomes the most recently used one)
+	[[nodiscard]] std::optional<script_match> load(const std::string& key) const;
+	// Store the matches with the given key, then evict the least recently used entries exceeding the maximum size.
+	// Returns false if the matches could not be stored (or they're degraded)
+	bool store(const std::string& key, const script_match& matches) const;
+
+  private:
+	void evict() const;
+
+  private:
+	std::filesystem::path m_directory;
+	uintmax_t m_max_size;
+};
+}; // namespace nd
@@ -1,6 +1,14 @@
 #include "matching.h"
 
+#include "columnar.h"
 #include "diff.h"
+#include "utility/utility.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <numeric>
+#include <unordered_set>
 
 #if defined(ND_PARALLELIZE)
 #include <execution>
@@ -9,6 +17,8 @@
 #ifdef ND_STATISTICS_ENABLED
 #include "utility/statistic.h"
 #include "utility/timer.h"
+
+#include <mutex>
 #endif
 
 ///
@@ -19,6 +29,16 @@ namespace nd
 // Used for infinite cost
 constexpr float float_inf = std::numeric_limits<float>::max();
 
+/*
+ * Mixes the bits of a hash (splitmix64 finalizer), so that hashes of similar values are unrelated.
+ */
+static inline uint64_t mix_hash(uint64_t hash)
+{
+	hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+	hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+	return hash ^ (hash >> 31);
+}
+
 /*
  * Node edit cost function described in NodeGit's paper work.
  * Note: this function is used by the matching algorithm for obtaining a nd::ref_match<node_ref> object, namely
@@ -64,69 +84,437 @@ float edit_cost(const node& ancestor, const node& version, const ref_match<graph
 }
 
 /*
- * Graph edit cost function described in NodeGit's paper work.
- * Note: this function is used by the matching algorithm for obtaining a nd::ref_match<graph_ref> object, namely
- * a matching between graphs of two scripts.
+ * Returns the maximum number of changed properties (out of total) such that the normalized edit cost does not exceed
+ * the bound, i.e. the number of changes after which a bounded edit cost evaluation can stop.
+ */
+static int max_changed_properties(int total, float bound)
+{
+	if (total == 0 || bound >= 1) { return total; }
+	if (bound < 0) { return -1; }
+	// Note: the same float division of the edit cost is used, so that rounding can't change the result
+	int max_changed = static_cast<int>(bound * total);
+	while (max_changed < total && (max_changed + 1) / static_cast<float>(total) <= bound) { ++max_changed; }
+	while (max_changed >= 0 && max_changed / static_cast<float>(total) > bound) { --max_changed; }
+	return max_changed;
+}
+
+/*
+ * Bounded node edit cost function (branch and bound): same as the node edit cost function, but properties are
+ * compared only until the number of changed properties makes the edit cost exceed the bound.
  *
  * Function parameters:
- *	- ancestor: ancestor graph
- *	- version: version graph
+ *	- ancestor: ancestor node
+ *	- version: version node
+ *	- graph_matches: bidirectional map of graph matches calculated so far
+ *	- node_matches: bidirectional map of node matches calculated so far
+ *	- bound: upper bound of the edit costs of interest (e.g. the best edit cost found so far)
  *
- * Returns: the cost required for editing the ancestor graph so to be the version graph. Edit cost is normalized in the
-			range [0, 1] (actually it can be >=1, but it can be clamped to 1).
+ * Returns: the edit cost if it does not exceed the bound, otherwise a lower bound of the edit cost exceeding the bound.
  */
-float edit_cost(const graph& ancestor, const graph& version)
+float edit_cost(const node& ancestor, const node& version, const ref_match<graph_ref>& graph_matches,
+				const ref_match<node_ref>& node_matches, float bound)
 {
-	float cost = 0;
+	// If different type ==> max cost
+	if (get_node_type(ancestor) != get_node_type(version)) { return nd::float_inf; }
 
-	// Count nodes for each type (ancestor)
-	std::unordered_map<std::string, int> ancestor_type_count;
-	for (const auto& [node_id, node] : ancestor.nodes)
+	const int total = ancestor.node_values.size() + ancestor.node_references.size() +
+					  ancestor.graph_references.size() + ancestor.texture_references.size() +
+					  ancestor.input_references.size();
+	const int max_changed  = max_changed_properties(total, bound);
+	int changed_properties = 0;
+	auto lower_bound_cost  = [&]() { return changed_properties / static_cast<float>(total); };
+
+	// Number of property value changed (values are most of the properties, so they're checked one by one)
+	for (const auto& [property_name, version_value] : version.node_values)
 	{
-		const std::string& node_type = get_node_type(node);
-		if (ancestor_type_count.contains(node_type)) { ++ancestor_type_count.at(node_type); }
-		else
+		if (ancestor.node_values.at(property_name) != version_value && ++changed_properties > max_changed)
 		{
-			ancestor_type_count[node_type] = 1;
+			return lower_bound_cost();
 		}
 	}
 
-	// Count nodes for each type (version)
-	std::unordered_map<std::string, int> version_type_count;
-	for (const auto& [node_id, node] : version.nodes)
+	// Number of node reference changed
+	changed_properties += diff_node_references(ancestor.node_references, version.node_references, node_matches);
+	if (changed_properties > max_changed) { return lower_bound_cost(); }
+
+	// Number of graph references changed
+	changed_properties += diff_graph_references(ancestor.graph_references, version.graph_references, graph_matches);
+	if (changed_properties > max_changed) { return lower_bound_cost(); }
+
+	// Number of node texture changed
+	changed_properties += diff_texture_references(ancestor.texture_references, version.texture_references);
+	if (changed_properties > max_changed) { return lower_bound_cost(); }
+
+	// Number of input edge changed
+	changed_properties += diff_input_references(ancestor.input_references, version.input_references, node_matches);
+	return lower_bound_cost();
+}
+
+/*
+ * Bounded node edit cost function on the rows of a columnar graph (see nd::columnar_graph): same as the bounded node
+ * edit cost function, but properties are compared by looping over the index-aligned columns of the rows. Nodes without
+ * a row (i.e. not conforming to the schema of their type) are compared by their properties.
+ *
+ * Function parameters:
+ *	- ancestor: ancestor node
+ *	- version: version node
+ *	- graph_matches: bidirectional map of graph matches calculated so far
+ *	- node_matches: bidirectional map of node matches calculated so far
+ *	- bound: upper bound of the edit costs of interest (e.g. the best edit cost found so far)
+ *
+ * Returns: the edit cost if it does not exceed the bound, otherwise a lower bound of the edit cost exceeding the bound.
+ */
+float edit_cost(const columnar_node& ancestor, const columnar_node& version, const ref_match<graph_ref>& graph_matches,
+				const ref_match<node_ref>& node_matches, float bound)
+{
+	if (!ancestor.has_row() || !version.has_row())
 	{
-		const std::string& node_type = get_node_type(node);
-		if (ancestor_type_count.contains(node_type)) { --ancestor_type_count.at(node_type); }
-		else if (version_type_count.contains(node_type))
-		{
-			++version_type_count.at(node_type);
-		}
-		else
+		return edit_cost(*ancestor.node, *version.node, graph_matches, node_matches, bound);
+	}
+	// If different type (i.e. different schema) ==> max cost
+	if (ancestor.schema != version.schema) { return nd::float_inf; }
+
+	const int total		   = static_cast<int>(ancestor.schema->size());
+	const int max_changed  = max_changed_properties(total, bound);
+	int changed_properties = 0;
+	auto lower_bound_cost  = [&]() { return changed_properties / static_cast<float>(total); };
+
+	// Number of property value changed (values are most of the properties, so they're checked one by one)
+	const std::span<const value> ancestor_values = ancestor.node_values();
+	const std::span<const value> version_values	 = version.node_values();
+	for (size_t column = 0; column < version_values.size(); ++column)
+	{
+		if (ancestor_values[column] != version_values[column] && ++changed_properties > max_changed)
 		{
-			version_type_count[node_type] = 1;
+			return lower_bound_cost();
 		}
 	}
 
-	// Cost
-	for (const auto& [node_type, count] : ancestor_type_count)
+	// Number of node reference changed
+	changed_properties += diff_node_references(ancestor, version, node_matches);
+	if (changed_properties > max_changed) { return lower_bound_cost(); }
+
+	// Number of graph references changed
+	changed_properties += diff_graph_references(ancestor, version, graph_matches);
+	if (changed_properties > max_changed) { return lower_bound_cost(); }
+
+	// Number of node texture changed
+	changed_properties += diff_texture_references(ancestor, version);
+	if (changed_properties > max_changed) { return lower_bound_cost(); }
+
+	// Number of input edge changed
+	changed_properties += diff_input_references(ancestor, version, node_matches);
+	return lower_bound_cost();
+}
+
+/*
+ * Dense cache of the edit costs computed by the matching algorithm between <ancestor, version> pairs of objects.
+ * Costs are stored row-wise (one row for each version object), so that all the costs involving a version object can be
+ * invalidated at once when a new match could have changed them.
+ * Lower bounds of edit costs (found by bounded edit cost evaluations) can be cached too, so that pairs known to exceed
+ * a bound are not evaluated again.
+ */
+class cost_cache
+{
+  public:
+	cost_cache(size_t version_size, size_t ancestor_size)
+		: m_ancestor_size(ancestor_size), m_costs(version_size * ancestor_size, 0.0f),
+		  m_is_cached(version_size * ancestor_size, false)
+	{
+	}
+
+	// Returns true if the cost of the <ancestor, version> pair is cached
+	[[nodiscard]] inline bool contains(size_t version_idx, size_t ancestor_idx) const
 	{
-		cost += abs(count);
+		return m_is_cached[version_idx * m_ancestor_size + ancestor_idx] == cached_cost;
 	}
-	for (const auto& [node_type, count] : version_type_count)
+	// Returns true if the cost of the <ancestor, version> pair, or a lower bound of it, is cached
+	[[nodiscard]] inline bool contains_bound(size_t version_idx, size_t ancestor_idx) const
 	{
-		cost += abs(count);
+		return m_is_cached[version_idx * m_ancestor_size + ancestor_idx] != not_cached;
 	}
-	// Normalize cost
-	return cost / static_cast<float>(ancestor.nodes.size());
+	// Returns the cached cost (or lower bound of the cost) of the <ancestor, version> pair
+	[[nodiscard]] inline float at(size_t version_idx, size_t ancestor_idx) const
+	{
+		assert(contains_bound(version_idx, ancestor_idx) && "Trying to read a non cached cost");
+		return m_costs[version_idx * m_ancestor_size + ancestor_idx];
+	}
+	// Store the cost of the <ancestor, version> pair
+	inline void store(size_t version_idx, size_t ancestor_idx, float cost)
+	{
+		m_costs[version_idx * m_ancestor_size + ancestor_idx]	  = cost;
+		m_is_cached[version_idx * m_ancestor_size + ancestor_idx] = cached_cost;
+	}
+	// Store a lower bound of the cost of the <ancestor, version> pair
+	inline void store_bound(size_t version_idx, size_t ancestor_idx, float cost_bound)
+	{
+		m_costs[version_idx * m_ancestor_size + ancestor_idx]	  = cost_bound;
+		m_is_cached[version_idx * m_ancestor_size + ancestor_idx] = cached_bound;
+	}
+	// Invalidate all the cached costs of a version object
+	inline void invalidate(size_t version_idx)
+	{
+		auto row_begin = m_is_cached.begin() + version_idx * m_ancestor_size;
+		std::fill(row_begin, row_begin + m_ancestor_size, not_cached);
+	}
+	// Invalidate all the cached costs
+	inline void clear() { std::fill(m_is_cached.begin(), m_is_cached.end(), not_cached); }
+
+  private:
+	// Cache state of a pair
+	static constexpr uint8_t not_cached	  = 0;
+	static constexpr uint8_t cached_cost  = 1;
+	static constexpr uint8_t cached_bound = 2;
+
+	size_t m_ancestor_size;
+	std::vector<float> m_costs;
+	// Note: std::vector<bool> is not used since rows are written concurrently when ND_PARALLELIZE is defined
+	std::vector<uint8_t> m_is_cached;
+};
+
+/*
+ * A candidate <ancestor, version> match evaluated by the matching algorithm.
+ * Candidates are ordered by edit cost; ties are broken by the lowest version index first, and then by the lowest
+ * ancestor index, so that the best candidate does not depend on the order in which candidates are evaluated.
+ */
+struct match_candidate
+{
+	static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+	float cost			= nd::float_inf;
+	size_t version_idx	= npos;
+	size_t ancestor_idx = npos;
+
+	bool operator<(const match_candidate& other) const
+	{
+		return std::tie(cost, version_idx, ancestor_idx) < std::tie(other.cost, other.version_idx, other.ancestor_idx);
+	}
+	bool operator==(const match_candidate& other) const = default;
+};
+
+/*
+ * The best candidate match of a version object, as stored in the min-heap of the heap matching engine (see
+ * nd::match_engine). The stamp counts how many times the edit costs of the version object had been invalidated when the
+ * candidate was pushed: if they have been invalidated since then, the candidate is outdated.
+ */
+struct heap_candidate
+{
+	match_candidate candidate = {};
+	size_t stamp			  = 0;
+
+	// Note: order is reversed since std heap algorithms build a max-heap
+	bool operator<(const heap_candidate& other) const { return other.candidate < candidate; }
+};
+
+/*
+ * A partial matching kept by the beam matching engine (see nd::match_engine): the matches found by the pass so far, in
+ * order, and the resulting total matching cost (i.e. the sum of the edit costs of the matches, plus the number of
+ * objects left to match).
+ * The best candidates of each version object (a row) are cached, and inherited by the partial matchings extending it:
+ * a row is searched again only if it's dirty, namely if its edit costs could have changed or one of its best
+ * candidates got matched.
+ */
+template <typename RefType>
+struct beam_state
+{
+	ref_match<RefType> match			 = {};
+	std::vector<int32_t> ancestor_match	 = {};
+	std::vector<int32_t> version_match	 = {};
+	std::vector<match_candidate> matches = {};
+	float cost							 = 0;
+	// Hash of the set of matches (it does not depend on their order), used for discarding duplicated states
+	size_t key = 0;
+	// Best candidates of each version object (row-wise, at most beam width per row, sorted) and their number
+	std::vector<match_candidate> row_candidates = {};
+	std::vector<size_t> row_sizes				= {};
+	std::vector<char> is_row_dirty				= {};
+};
+
+/*
+ * A bucket groups the ancestor and version objects sharing the same bucket key; only objects in the same bucket are
+ * evaluated as candidate matches by the matching algorithm.
+ * Objects are stored by index, and positions in a bucket follow the same order of indices.
+ */
+struct match_bucket
+{
+	// Sorted indices of the ancestor/version objects in the bucket
+	std::vector<size_t> ancestors = {};
+	std::vector<size_t> versions  = {};
+	// Sorted positions (in ancestors/versions) of the objects still to match
+	std::vector<size_t> ancestor_to_match = {};
+	std::vector<size_t> version_to_match  = {};
+	// Edit costs computed so far, indexed by <version, ancestor> positions
+	cost_cache cache = {0, 0};
+	// Best candidate among the objects still to match (valid only if the bucket is not dirty)
+	match_candidate best_candidate = {};
+	bool is_dirty				   = true;
+};
+
+/*
+ * Defines a function that given an object returns the key of the bucket it belongs to.
+ */
+template <typename ObjectType>
+using bucket_fn = std::function<std::string(const ObjectType&)>;
+
+/*
+ * Solves the (rectangular) assignment problem using the Hungarian algorithm (with row/column potentials): given a cost
+ * matrix with rows <= columns, it assigns each row to a different column so that the total cost is minimum.
+ * Complexity: O(rows^2 * columns).
+ *
+ * Function parameters:
+ *	- costs: row-wise cost matrix (costs must be finite)
+ *	- rows: number of rows of the cost matrix
+ *	- columns: number of columns of the cost matrix (it must be >= rows)
+ *
+ * Returns: the column assigned to each row.
+ */
+static std::vector<size_t> solve_assignment(const std::vector<double>& costs, size_t rows, size_t columns)
+{
+	assert(rows <= columns && "Assignment problem requires rows <= columns");
+	constexpr double double_inf = std::numeric_limits<double>::max();
+
+	// Note: rows and columns are 1-based, column 0 is a virtual column used as root of the augmenting paths and row 0
+	// means no row
+	std::vector<double> row_potential(rows + 1, 0.0), column_potential(columns + 1, 0.0), min_slack(columns + 1);
+	std::vector<size_t> column_row(columns + 1, 0), previous_column(columns + 1, 0);
+	std::vector<uint8_t> is_column_visited(columns + 1);
+	for (size_t row = 1; row <= rows; ++row)
+	{
+		// Search the shortest augmenting path from the row to a free column (Dijkstra-like)
+		column_row[0] = row;
+		size_t column = 0;
+		std::fill(min_slack.begin(), min_slack.end(), double_inf);
+		std::fill(is_column_visited.begin(), is_column_visited.end(), false);
+		do
+		{
+			is_column_visited[column] = true;
+			const size_t column_owner = column_row[column];
+			const double* owner_costs = costs.data() + (column_owner - 1) * columns;
+			double delta			  = double_inf;
+			size_t next_column		  = 0;
+			for (size_t other_column = 1; other_column <= columns; ++other_column)
+			{
+				if (is_column_visited[other_column]) { continue; }
+				const double slack = owner_costs[other_column - 1] - row_potential[column_owner] -
+									 column_potential[other_column];
+				if (slack < min_slack[other_column])
+				{
+					min_slack[other_column]		  = slack;
+					previous_column[other_column] = column;
+				}
+				if (min_slack[other_column] < delta)
+				{
+					delta		= min_slack[other_column];
+					next_column = other_column;
+				}
+			}
+			// Update potentials, so that visited columns keep zero slack
+			for (size_t other_column = 0; other_column <= columns; ++other_column)
+			{
+				if (is_column_visited[other_column])
+				{
+					row_potential[column_row[other_column]] += delta;
+					column_potential[other_column] -= delta;
+				}
+				else
+				{
+					min_slack[other_column] -= delta;
+				}
+			}
+			column = next_column;
+		} while (column_row[column] != 0);
+
+		// Flip the assignments along the augmenting path
+		do
+		{
+			const size_t path_column = previous_column[column];
+			column_row[column]		 = column_row[path_column];
+			column					 = path_column;
+		} while (column != 0);
+	}
+
+	std::vector<size_t> row_column(rows);
+	for (size_t column = 1; column <= columns; ++column)
+	{
+		if (column_row[column] != 0) { row_column[column_row[column] - 1] = column - 1; }
+	}
+	return row_column;
 }
 
+/*
+ * Statistics of a call of a matching function (e.g. nd::match_nodes), aggregated over all the matchings it runs (e.g.
+ * one for each pair of node regions): counters are summed, and so are the counters of passes with the same index.
+ */
+struct match_call_statistics
+{
+#ifdef ND_STATISTICS_ENABLED
+	std::mutex mutex;
+	nd::json json = {{"matchings", 0}};
+
+	// Add the statistics of a matching (see nd::match_objects)
+	void add(const nd::json& match_statistics)
+	{
+		static constexpr const char* counters[]		 = {"time", "cost_cache_hits", "cost_evaluations", "early_exits",
+														"zero_cost_shortcuts"};
+		static constexpr const char* pass_counters[] = {"time",				"iterations",  "matches", "cost_cache_hits",
+														"cost_evaluations", "early_exits", "zero_cost_shortcuts"};
+		// Sum of counters, keeping integer counters integer
+		auto accumulate = [](nd::json& total, const nd::json& value) {
+			if (total.is_null()) { total = value; }
+			else if (value.is_number_integer()) { total = total.get<size_t>() + value.get<size_t>(); }
+			else { total = total.get<double>() + value.get<double>(); }
+		};
+		std::lock_guard lock(mutex);
+		json["matchings"] = json["matchings"].get<size_t>() + 1;
+		for (const char* counter : counters)
+		{
+			accumulate(json[counter], match_statistics[counter]);
+		}
+		if (!match_statistics.contains("passes")) { return; }
+		for (size_t pass_idx = 0; pass_idx < match_statistics["passes"].size(); ++pass_idx)
+		{
+			const nd::json& pass_statistics = match_statistics["passes"][pass_idx];
+			nd::json& call_pass_statistics	= json["passes"][pass_idx];
+			call_pass_statistics["engine"]	= pass_statistics["engine"];
+			for (const char* counter : pass_counters)
+			{
+				accumulate(call_pass_statistics[counter], pass_statistics[counter]);
+			}
+		}
+	}
+
+	// Collect the statistics of the call (wall_time is the time taken by the whole call, in milliseconds)
+	void collect(const char* function, size_t ancestor_size, size_t version_size, double wall_time)
+	{
+		json["function"]	  = function;
+		json["ancestor_size"] = ancestor_size;
+		json["version_size"]  = version_size;
+		json["wall_time"]	  = wall_time;
+		auto& statistics	  = nd::statistics_collector::instance();
+		std::lock_guard lock(statistics.mutex);
+		statistics.json["match_calls"].push_back(json);
+	}
+#endif
+};
+
 /*
  * Matching algorithm described in NodeGit's paper work (+ passes implementation).
  * Given an ancestor and version unordered collection of objects (general implementation), it finds greedly
  * the best match between those two collections' objects.
  *
+ * Objects are indexed by sorting their ids, and ties between candidate matches with the same edit cost are broken by
+ * the lowest indices (see nd::match_candidate), hence serial and parallel executions find the same matches.
+ * Objects can be partitioned in buckets, so that only pairs of objects in the same bucket are evaluated; each greedy
+ * step only searches again the buckets whose objects or edit costs changed since the previous step.
+ * Edit costs are cached between greedy steps: after a new match is found, only the costs of the version objects
+ * depending on the newly matched version object are evaluated again.
+ * Each pass finds its matches using the engine it selects (see nd::match_engine); all the engines find the same
+ * matches.
+ *
  * Template parameters:
  *	- RefType: type of references to match
+ *	- CostFn: type of the passes' edit cost function (see nd::basic_match_pass). If it takes the objects instead of
+			  their references, edit costs are evaluated on objects looked up once before matching
  *	- MapContainer: type of the unordered collection container (it shall be a Map-like container, i.e. it shall store
 					key-value pairs)
  *
@@ -134,12 +522,28 @@ float edit_cost(const graph& ancestor, const graph& version)
  *	- ancestor: unordered collection of ancestor <id, object> pairs
  *	- version: unordered collection of version <id, object> pairs
  *	- match_passes: vector of passes to use (note: this vector must have size >= 1)
+ *	- dependents: map from a version object id to the ids of the version objects whose edit cost can change when the
+				  former gets matched (ids not in the map have no dependents, dependents not in the version collection
+				  are ignored). If it is nullptr, edit costs are never cached.
+ *	- bucket_fn: function returning the bucket key of an object. Pairs of objects in different buckets must have an
+				 infinite edit cost in all passes. If it is not set, all the objects are in the same bucket.
+ *	- initial_match: matches known before running the algorithm (e.g. found by a prematching step); objects already
+					 matched are not matched again.
+ *	- budget: budget of the matching (see nd::match_budget); if it expires, the objects still to match are left
+			  without a match and the returned matches are marked as degraded. If it is nullptr, there's no budget.
+ *	- call_statistics: statistics of the calling matching function, which the statistics of this matching are added
+					   to (only if statistics are enabled). If it is nullptr, they're not aggregated.
  *
  * Returns: bidirectional map containing matched objects ids.
  */
-template <typename RefType, typename MapContainer, typename = std::enable_if_t<nd::is_mapping_v<MapContainer>>>
+template <typename RefType, typename CostFn, typename MapContainer,
+		  typename = std::enable_if_t<nd::is_mapping_v<MapContainer>>>
 ref_match<RefType> match_objects(const MapContainer& ancestor, const MapContainer& version,
-								 const std::vector<match_pass<RefType>>& match_passes)
+								 const std::vector<basic_match_pass<RefType, CostFn>>& match_passes,
+								 const std::unordered_map<RefType, std::vector<RefType>>* dependents = nullptr,
+								 const bucket_fn<typename MapContainer::mapped_type>& bucket_fn = nullptr,
+								 ref_match<RefType> initial_match = {}, const match_budget* budget = nullptr,
+								 match_call_statistics* call_statistics = nullptr)
 {
 #ifdef ND_STATISTICS_ENABLED
 	nd::json match_statistics;
@@ -152,141 +556,1296 @@ ref_match<RefType> match_objects(const MapContainer& ancestor, const MapContaine
 	std::vector<float> step_total_match_cost;
 	step_total_match_cost.reserve(std::min(ancestor.size(), version.size()));
 
+	std::atomic<size_t> cost_cache_hits	 = 0;
+	std::atomic<size_t> cost_evaluations = 0;
+	// Edit cost evaluations exceeding their bound, i.e. cut short by bounded edit cost functions
+	std::atomic<size_t> early_exits = 0;
+	// Searches (of a version object's best candidate, or of a bucket's best candidate) cut short by a zero edit cost
+	// candidate
+	std::atomic<size_t> zero_cost_shortcuts = 0;
+	// Steps performed by the engine of the current pass (e.g. greedy steps)
+	size_t pass_iterations = 0;
+
 	nd::timer timer;
 #endif
-	// Init. empty match map
-	ref_match<RefType> match = {};
+	// Init. match map with the initial matches
+	ref_match<RefType> match = std::move(initial_match);
 	// Add match between invalid references (because they're the same in all versions)
 	match.add_match(RefType::invalid_ref, RefType::invalid_ref);
 
-	// Set containing all the ancestor objects to match
-	std::unordered_set<RefType> ancestor_to_match = {};
-	ancestor_to_match.reserve(ancestor.size());
+	// Sorted ancestor and version objects ids (of objects still to match): the position of an id is the index of its
+	// object
+	std::vector<RefType> ancestor_ids;
+	ancestor_ids.reserve(ancestor.size());
 	for (const auto& [object_id, object] : ancestor)
 	{
-		ancestor_to_match.emplace(object_id);
+		if (!match.has_match_in_version(object_id)) { ancestor_ids.push_back(object_id); }
 	}
+	std::sort(ancestor_ids.begin(), ancestor_ids.end());
 
-	// Set containing all the version objects to match
-	std::unordered_set<RefType> version_to_match;
-	version_to_match.reserve(version.size());
+	std::vector<RefType> version_ids;
+	version_ids.reserve(version.size());
 	for (const auto& [object_id, object] : version)
 	{
-		version_to_match.emplace(object_id);
+		if (!match.has_match_in_ancestor(object_id)) { version_ids.push_back(object_id); }
+	}
+	std::sort(version_ids.begin(), version_ids.end());
+
+	// Objects of the ids (pre-resolved, so that edit costs are evaluated without looking up objects)
+	using ObjectType = typename MapContainer::mapped_type;
+	std::vector<const ObjectType*> ancestor_objects(ancestor_ids.size()), version_objects(version_ids.size());
+	for (size_t ancestor_idx = 0; ancestor_idx < ancestor_ids.size(); ++ancestor_idx)
+	{
+		ancestor_objects[ancestor_idx] = &ancestor.at(ancestor_ids[ancestor_idx]);
+	}
+	for (size_t version_idx = 0; version_idx < version_ids.size(); ++version_idx)
+	{
+		version_objects[version_idx] = &version.at(version_ids[version_idx]);
+	}
+#ifdef ND_STATISTICS_ENABLED
+	// Initial matches have zero cost
+	match_statistics["initial_match_size"] = ancestor.size() - ancestor_ids.size();
+	total_match_cost -= 2.0 * (ancestor.size() - ancestor_ids.size());
+#endif
+
+	// Map an ancestor/version object id to its index (used for invalidating cached costs, and by engines walking
+	// objects by id)
+	std::unordered_map<RefType, size_t> ancestor_index, version_index;
+	ancestor_index.reserve(ancestor_ids.size());
+	for (size_t ancestor_idx = 0; ancestor_idx < ancestor_ids.size(); ++ancestor_idx)
+	{
+		ancestor_index.emplace(ancestor_ids[ancestor_idx], ancestor_idx);
+	}
+	version_index.reserve(version_ids.size());
+	for (size_t version_idx = 0; version_idx < version_ids.size(); ++version_idx)
+	{
+		version_index.emplace(version_ids[version_idx], version_idx);
+	}
+
+	// Partition objects in buckets, storing for each object its bucket and its position in the bucket
+	std::vector<match_bucket> buckets;
+	std::unordered_map<std::string, size_t> bucket_index;
+	auto find_bucket = [&](const typename MapContainer::mapped_type& object) -> size_t {
+		auto [it, inserted] = bucket_index.try_emplace(bucket_fn ? bucket_fn(object) : "", buckets.size());
+		if (inserted) { buckets.emplace_back(); }
+		return it->second;
+	};
+	std::vector<size_t> ancestor_bucket(ancestor_ids.size()), ancestor_position(ancestor_ids.size());
+	for (size_t ancestor_idx = 0; ancestor_idx < ancestor_ids.size(); ++ancestor_idx)
+	{
+		ancestor_bucket[ancestor_idx]	= find_bucket(ancestor.at(ancestor_ids[ancestor_idx]));
+		match_bucket& bucket			= buckets[ancestor_bucket[ancestor_idx]];
+		ancestor_position[ancestor_idx] = bucket.ancestors.size();
+		bucket.ancestors.push_back(ancestor_idx);
+	}
+	std::vector<size_t> version_bucket(version_ids.size()), version_position(version_ids.size());
+	for (size_t version_idx = 0; version_idx < version_ids.size(); ++version_idx)
+	{
+		version_bucket[version_idx]	  = find_bucket(version.at(version_ids[version_idx]));
+		match_bucket& bucket		  = buckets[version_bucket[version_idx]];
+		version_position[version_idx] = bucket.versions.size();
+		bucket.versions.push_back(version_idx);
+	}
+
+	// Edit costs are cached only if dependents are known
+	const bool use_cache = dependents != nullptr;
+	for (match_bucket& bucket : buckets)
+	{
+		bucket.ancestor_to_match.resize(bucket.ancestors.size());
+		std::iota(bucket.ancestor_to_match.begin(), bucket.ancestor_to_match.end(), 0);
+		bucket.version_to_match.resize(bucket.versions.size());
+		std::iota(bucket.version_to_match.begin(), bucket.version_to_match.end(), 0);
+		if (use_cache) { bucket.cache = cost_cache(bucket.versions.size(), bucket.ancestors.size()); }
+	}
+	size_t ancestor_to_match_size = ancestor_ids.size();
+	size_t version_to_match_size  = version_ids.size();
+
+	// Matches of the objects to match by index, namely the index of the matched version/ancestor object (or unmatched),
+	// so that engines check matches without looking up ids. The match map is kept updated too, since edit cost
+	// functions take it
+	constexpr int32_t unmatched = -1;
+	assert(ancestor_ids.size() < std::numeric_limits<int32_t>::max() &&
+		   version_ids.size() < std::numeric_limits<int32_t>::max() && "Too many objects to match");
+	std::vector<int32_t> ancestor_match(ancestor_ids.size(), unmatched), version_match(version_ids.size(), unmatched);
+	// Dependents of the version objects by index (dependents not in the version collection are ignored)
+	std::vector<std::vector<size_t>> version_dependents(use_cache ? version_ids.size() : 0);
+	for (size_t version_idx = 0; use_cache && version_idx < version_ids.size(); ++version_idx)
+	{
+		auto object_dependents = dependents->find(version_ids[version_idx]);
+		if (object_dependents == dependents->end()) { continue; }
+		for (const RefType& dependent_id : object_dependents->second)
+		{
+			auto dependent = version_index.find(dependent_id);
+			if (dependent != version_index.end()) { version_dependents[version_idx].push_back(dependent->second); }
+		}
 	}
 
-	// Extract first match pass
+	// Edit cost function and threshold of the current pass (see the passes loop below)
 	assert(match_passes.size() > 0);
-	size_t pass_idx			 = 0;
-	cost_fn<RefType> cost_fn = match_passes[pass_idx].cost_fn;
-	float threshold			 = match_passes[pass_idx].threshold;
+	const CostFn* cost_fn = nullptr;
+	float threshold		  = 0;
+	// Sorted positions (in their bucket) of the candidate ancestor objects of each version object in the current pass,
+	// only for the version objects whose candidates are known (see nd::match_candidates)
+	std::vector<std::vector<size_t>> candidate_positions;
+	std::vector<char> has_candidates;
 
-#if defined(ND_PARALLELIZE)
-	std::mutex m;
+	// Evaluate the edit cost of a pair of objects with the edit cost function of the current pass. If the edit cost
+	// function takes a bound, edit costs exceeding it can be returned as lower bounds (greater than the bound)
+	auto evaluate_cost = [&](const RefType& ancestor_id, const ObjectType& ancestor_object, const RefType& version_id,
+							 const ObjectType& version_object, const ref_match<RefType>& cost_match,
+							 float bound) -> float {
+		if constexpr (std::is_invocable_r_v<float, const CostFn&, const ObjectType&, const ObjectType&,
+											const ref_match<RefType>&, float>)
+		{
+			return (*cost_fn)(ancestor_object, version_object, cost_match, bound);
+		}
+		else if constexpr (std::is_invocable_r_v<float, const CostFn&, const ObjectType&, const ObjectType&,
+												 const ref_match<RefType>&>)
+		{
+			return (*cost_fn)(ancestor_object, version_object, cost_match);
+		}
+		else
+		{
+			return (*cost_fn)(ancestor_id, version_id, cost_match);
+		}
+	};
+	auto evaluate_pair_cost = [&](size_t ancestor_idx, size_t version_idx, const ref_match<RefType>& cost_match,
+								  float bound = nd::float_inf) -> float {
+		return evaluate_cost(ancestor_ids[ancestor_idx], *ancestor_objects[ancestor_idx], version_ids[version_idx],
+							 *version_objects[version_idx], cost_match, bound);
+	};
+
+	// Returns true if the budget is expired, marking the matches found so far as degraded
+	auto is_budget_expired = [&]() -> bool {
+		if (budget == nullptr || !budget->is_expired()) { return false; }
+		match.set_degraded();
+		return true;
+	};
+
+	// Find the best candidate match for a version object among all the ancestor objects to match in its bucket (or
+	// among its candidate ancestor objects still to match, if they're known)
+	// Note: if the budget is expired no candidate is found (the caller checks it before using the candidate)
+	auto find_best_ancestor = [&](match_bucket& bucket, size_t version_pos) -> match_candidate {
+		if (budget != nullptr && budget->is_expired()) { return {}; }
+		const size_t version_idx = bucket.versions[version_pos];
+		match_candidate best_candidate;
+#ifdef ND_STATISTICS_ENABLED
+		size_t row_cache_hits = 0, row_cost_evaluations = 0, row_early_exits = 0;
 #endif
-	// As long as there are possible matching pairs performs a greedy assignment step
-	while (!version_to_match.empty() && !ancestor_to_match.empty())
-	{
-		// Initialize best match
-		float best_match_edit_cost = nd::float_inf;
-		std::pair<RefType, RefType> best_match;
-		// Perform a minimum edit cost search
-#if defined(ND_PARALLELIZE)
-		bool found_flag = false;
-		// Find less expensive assignment
-		std::for_each(std::execution::par_unseq, version_to_match.begin(), version_to_match.end(),
-					  [&](const RefType& version_object_id) {
-						  for (const RefType& ancestor_object_id : ancestor_to_match)
-						  {
-							  float cost = cost_fn(ancestor_object_id, version_object_id, match);
-							  assert(cost >= 0 && "Negative cost not allowed");
-							  {
-								  std::lock_guard<std::mutex> l(m);
-								  if (found_flag) { return; }
-								  if (cost <= best_match_edit_cost)
-								  {
-									  best_match		   = {version_object_id, ancestor_object_id};
-									  best_match_edit_cost = cost;
-								  }
-								  // Cost zero is minimum, can't find better
-								  if (cost == 0) { found_flag = true; }
-							  }
-						  }
-					  });
-#else
-		for (const RefType& version_object_id : version_to_match)
+		const bool is_pruned = !has_candidates.empty() && has_candidates[version_idx];
+		for (size_t ancestor_pos : is_pruned ? candidate_positions[version_idx] : bucket.ancestor_to_match)
 		{
-			for (const RefType& ancestor_object_id : ancestor_to_match)
+			const size_t ancestor_idx = bucket.ancestors[ancestor_pos];
+			if (is_pruned && ancestor_match[ancestor_idx] != unmatched) { continue; }
+			// Only candidates better than the best one so far and below threshold are of interest, so edit costs
+			// exceeding the bound can be lower bounds
+			const float bound = std::min(best_candidate.cost, threshold);
+			float cost;
+			if (use_cache && bucket.cache.contains_bound(version_pos, ancestor_pos) &&
+				(bucket.cache.contains(version_pos, ancestor_pos) ||
+				 bucket.cache.at(version_pos, ancestor_pos) > bound))
 			{
-				float cost = cost_fn(ancestor_object_id, version_object_id, match);
-				assert(cost >= 0 && "Negative cost not allowed");
-				if (cost <= best_match_edit_cost)
-				{
-					best_match			 = {version_object_id, ancestor_object_id};
-					best_match_edit_cost = cost;
-				}
-				// Cost zero is minimum, can't find better
-				if (cost == 0) { goto check_match; }
+				cost = bucket.cache.at(version_pos, ancestor_pos);
+#ifdef ND_STATISTICS_ENABLED
+				++row_cache_hits;
+#endif
+			}
+			else
+			{
+				cost = evaluate_pair_cost(ancestor_idx, version_idx, match, bound);
+				if (use_cache && cost <= bound) { bucket.cache.store(version_pos, ancestor_pos, cost); }
+				else if (use_cache) { bucket.cache.store_bound(version_pos, ancestor_pos, cost); }
+#ifdef ND_STATISTICS_ENABLED
+				++row_cost_evaluations;
+				if (cost > bound) { ++row_early_exits; }
+#endif
+			}
+			assert(cost >= 0 && "Negative cost not allowed");
+			// Note: ancestor indices are visited in increasing order, so ties keep the lowest index
+			if (cost < best_candidate.cost)
+			{
+				best_candidate = {.cost = cost, .version_idx = version_idx, .ancestor_idx = ancestor_idx};
 			}
+			// Cost zero is minimum, can't find better
+			if (cost == 0) { break; }
 		}
-	check_match:
+#ifdef ND_STATISTICS_ENABLED
+		cost_cache_hits.fetch_add(row_cache_hits, std::memory_order_relaxed);
+		cost_evaluations.fetch_add(row_cost_evaluations, std::memory_order_relaxed);
+		early_exits.fetch_add(row_early_exits, std::memory_order_relaxed);
+		if (best_candidate.cost == 0) { zero_cost_shortcuts.fetch_add(1, std::memory_order_relaxed); }
 #endif
-		// If it's an assignment below threshold ==> add match to match map and remove matches from sets
-		if (best_match_edit_cost < threshold)
+		return best_candidate;
+	};
+
+	// Find the best candidate match among all the objects to match in a bucket
+	auto find_best_candidate = [&](match_bucket& bucket) -> match_candidate {
+#if defined(ND_PARALLELIZE)
+		// Lowest version position for which a zero cost candidate has been found: higher positions can't be better
+		std::atomic<size_t> zero_cost_version_pos = match_candidate::npos;
+		// Each version object is assigned its best candidate, then candidates are reduced to the minimum one
+		const match_candidate best_candidate = std::transform_reduce(
+			std::execution::par, bucket.version_to_match.begin(), bucket.version_to_match.end(), match_candidate{},
+			[](const match_candidate& c1, const match_candidate& c2) { return std::min(c1, c2); },
+			[&](size_t version_pos) -> match_candidate {
+				if (version_pos > zero_cost_version_pos.load(std::memory_order_relaxed)) { return {}; }
+				match_candidate row_best_candidate = find_best_ancestor(bucket, version_pos);
+				if (row_best_candidate.cost == 0)
+				{
+					size_t current_pos = zero_cost_version_pos.load(std::memory_order_relaxed);
+					while (version_pos < current_pos &&
+						   !zero_cost_version_pos.compare_exchange_weak(current_pos, version_pos,
+																		std::memory_order_relaxed))
+					{
+					}
+				}
+				return row_best_candidate;
+			});
+#else
+		match_candidate best_candidate;
+		for (size_t version_pos : bucket.version_to_match)
 		{
-			match.add_match(best_match.second, best_match.first);
-			version_to_match.erase(best_match.first);
-			ancestor_to_match.erase(best_match.second);
+			best_candidate = std::min(best_candidate, find_best_ancestor(bucket, version_pos));
+			// Cost zero is minimum, can't find better
+			if (best_candidate.cost == 0) { break; }
+		}
+#endif
 #ifdef ND_STATISTICS_ENABLED
-			// Decrease matching cost
-			total_match_cost = (total_match_cost - 2.0) + best_match_edit_cost;
-			step_total_match_cost.push_back(total_match_cost);
+		if (best_candidate.cost == 0) { zero_cost_shortcuts.fetch_add(1, std::memory_order_relaxed); }
 #endif
-		}
-		else
+		return best_candidate;
+	};
+
+	// Add a candidate match to the match map and remove its objects from the ones to match
+	auto add_match = [&](const match_candidate& candidate) {
+		match.add_match(ancestor_ids[candidate.ancestor_idx], version_ids[candidate.version_idx]);
+		ancestor_match[candidate.ancestor_idx] = static_cast<int32_t>(candidate.version_idx);
+		version_match[candidate.version_idx]   = static_cast<int32_t>(candidate.ancestor_idx);
+
+		match_bucket& bucket = buckets[version_bucket[candidate.version_idx]];
+		bucket.version_to_match.erase(std::lower_bound(bucket.version_to_match.begin(), bucket.version_to_match.end(),
+													   version_position[candidate.version_idx]));
+		bucket.ancestor_to_match.erase(std::lower_bound(bucket.ancestor_to_match.begin(),
+														bucket.ancestor_to_match.end(),
+														ancestor_position[candidate.ancestor_idx]));
+		bucket.is_dirty = true;
+		--version_to_match_size;
+		--ancestor_to_match_size;
+#ifdef ND_STATISTICS_ENABLED
+		++matched;
+		// Decrease matching cost
+		total_match_cost = (total_match_cost - 2.0) + candidate.cost;
+		step_total_match_cost.push_back(total_match_cost);
+#endif
+	};
+
+	// Invalidate the cached costs of the objects depending on a newly matched version object (they could have changed)
+	auto invalidate_dependents = [&](size_t version_idx) {
+		if (!use_cache) { return; }
+		for (size_t dependent_idx : version_dependents[version_idx])
 		{
-			++pass_idx;
-			if (pass_idx >= match_passes.size()) { break; }
-			cost_fn	  = match_passes[pass_idx].cost_fn;
-			threshold = match_passes[pass_idx].threshold;
+			if (version_match[dependent_idx] != unmatched) { continue; }
+			match_bucket& dependent_bucket = buckets[version_bucket[dependent_idx]];
+			dependent_bucket.cache.invalidate(version_position[dependent_idx]);
+			dependent_bucket.is_dirty = true;
 		}
-	}
+	};
+
+	// Scan engine: each greedy step searches the minimum edit cost candidate among all the pairs of objects to match
+	auto run_scan_pass = [&]() {
+		std::vector<match_bucket*> dirty_buckets;
+		dirty_buckets.reserve(buckets.size());
+		// As long as there are possible matching pairs performs a greedy assignment step
+		while (version_to_match_size > 0 && ancestor_to_match_size > 0 && !is_budget_expired())
+		{
 #ifdef ND_STATISTICS_ENABLED
-	timer.stop();
-	match_statistics["time"]			 = timer.milliseconds();
-	match_statistics["match_map_size"]	 = matched;
-	match_statistics["total_match_cost"] = step_total_match_cost;
-	nd::statistics_collector::instance().json["matches"].push_back(match_statistics);
+			++pass_iterations;
 #endif
-	return match;
-}
+			// Search again the buckets whose objects or edit costs could have changed since the previous step
+			dirty_buckets.clear();
+			for (match_bucket& bucket : buckets)
+			{
+				if (bucket.is_dirty || !use_cache) { dirty_buckets.push_back(&bucket); }
+			}
+#if defined(ND_PARALLELIZE)
+			std::for_each(std::execution::par, dirty_buckets.begin(), dirty_buckets.end(), [&](match_bucket* bucket) {
+				bucket->best_candidate = find_best_candidate(*bucket);
+				bucket->is_dirty	   = false;
+			});
+#else
+			for (match_bucket* bucket : dirty_buckets)
+			{
+				bucket->best_candidate = find_best_candidate(*bucket);
+				bucket->is_dirty	   = false;
+			}
+#endif
+			// Perform a minimum edit cost search among buckets' best candidates
+			match_candidate best_match;
+			for (const match_bucket& bucket : buckets)
+			{
+				best_match = std::min(best_match, bucket.best_candidate);
+			}
 
-/*
- * Matching algorithm described in NodeGit's paper work (only one pass is performed).
- * Given an ancestor and version unordered collection of objects (general implementation), it finds greedly
- * the best match between those two collections' objects.
- *
- * Template parameters:
- *	- RefType: type of references to match
+			// If it's not an assignment below threshold, or the search has been cut by the budget ==> the pass is over
+			if (best_match.cost >= threshold || is_budget_expired()) { return; }
+			add_match(best_match);
+
+			invalidate_dependents(best_match.version_idx);
+		}
+	};
+
+	// Heap engine: the best candidate match of each version object is kept in a min-heap, and each greedy step pops the
+	// minimum edit cost candidate. Popped candidates are discarded if their version object is already matched, or if
+	// its edit costs have been invalidated since they were pushed (lazy deletion); if only their ancestor object is
+	// already matched, the best candidate of the version object is searched again (using cached edit costs) and pushed
+	auto run_heap_pass = [&]() {
+		// Number of times the edit costs of each version object have been invalidated
+		std::vector<size_t> version_stamp(version_ids.size(), 0);
+		auto find_heap_candidate = [&](size_t version_idx) -> heap_candidate {
+			match_bucket& bucket = buckets[version_bucket[version_idx]];
+			return {.candidate = find_best_ancestor(bucket, version_position[version_idx]),
+					.stamp	   = version_stamp[version_idx]};
+		};
+
+		// Init. heap with the best candidates of all the version objects to match
+		std::vector<size_t> version_to_match;
+		version_to_match.reserve(version_to_match_size);
+		for (const match_bucket& bucket : buckets)
+		{
+			if (bucket.ancestor_to_match.empty()) { continue; }
+			for (size_t version_pos : bucket.version_to_match)
+			{
+				version_to_match.push_back(bucket.versions[version_pos]);
+			}
+		}
+		std::vector<heap_candidate> heap(version_to_match.size());
+#if defined(ND_PARALLELIZE)
+		std::transform(std::execution::par, version_to_match.begin(), version_to_match.end(), heap.begin(),
+					   find_heap_candidate);
+#else
+		std::transform(version_to_match.begin(), version_to_match.end(), heap.begin(), find_heap_candidate);
+#endif
+		std::make_heap(heap.begin(), heap.end());
+		auto push_heap_candidate = [&](size_t version_idx) {
+			heap.push_back(find_heap_candidate(version_idx));
+			std::push_heap(heap.begin(), heap.end());
+		};
+
+		// As long as there are possible matching pairs performs a greedy assignment step
+		while (!heap.empty() && ancestor_to_match_size > 0 && !is_budget_expired())
+		{
+#ifdef ND_STATISTICS_ENABLED
+			++pass_iterations;
+#endif
+			std::pop_heap(heap.begin(), heap.end());
+			const auto [candidate, stamp] = heap.back();
+			heap.pop_back();
+
+			// Discard outdated candidates, and candidates of version objects with no ancestor objects left to match
+			if (candidate.version_idx == match_candidate::npos || stamp != version_stamp[candidate.version_idx])
+			{
+				continue;
+			}
+			if (version_match[candidate.version_idx] != unmatched) { continue; }
+			// Note: the new best candidate of the version object can't be better than the popped one
+			if (ancestor_match[candidate.ancestor_idx] != unmatched)
+			{
+				push_heap_candidate(candidate.version_idx);
+				continue;
+			}
+
+			// If it's not an assignment below threshold ==> the pass is over
+			if (candidate.cost >= threshold) { return; }
+			add_match(candidate);
+
+			// Costs of the objects depending on the newly matched version object could have changed
+			for (size_t dependent_idx : version_dependents[candidate.version_idx])
+			{
+				if (version_match[dependent_idx] != unmatched) { continue; }
+				buckets[version_bucket[dependent_idx]].cache.invalidate(version_position[dependent_idx]);
+				++version_stamp[dependent_idx];
+				push_heap_candidate(dependent_idx);
+			}
+		}
+	};
+
+	// Optimal engine: the matches of each bucket are found by solving the assignment problem between its objects to
+	// match, minimizing the sum of the edit costs of the matched pairs plus the threshold for each version object left
+	// unmatched (i.e. only pairs below threshold are matched).
+	// Edit costs depend on the matches of other objects, hence the assignment problems are solved again using the edit
+	// costs given by the previous solution until it does not change, and then its matches are added to the match map.
+	// This is repeated for the objects still to match until no new match is found
+	auto run_optimal_pass = [&]() {
+		// Find the optimal matches between the objects to match in a bucket, evaluating edit costs with cost_match
+		auto find_optimal_matches = [&](match_bucket& bucket,
+										const ref_match<RefType>& cost_match) -> std::vector<match_candidate> {
+			const size_t versions_size	= bucket.version_to_match.size();
+			const size_t ancestors_size = bucket.ancestor_to_match.size();
+			if (versions_size == 0 || ancestors_size == 0) { return {}; }
+			// Cached edit costs are valid only for the match map
+			const bool use_bucket_cache = use_cache && &cost_match == &match;
+
+			// A version object is assigned either an ancestor object, or one of the dummy columns (i.e. it's left
+			// unmatched) with cost equal to threshold
+			const size_t columns = ancestors_size + versions_size;
+			std::vector<double> costs(versions_size * columns, threshold);
+			std::vector<float> pair_costs(versions_size * ancestors_size);
+#ifdef ND_STATISTICS_ENABLED
+			size_t bucket_cache_hits = 0, bucket_cost_evaluations = 0, bucket_early_exits = 0;
+#endif
+			for (size_t row = 0; row < versions_size; ++row)
+			{
+				// Note: the caller checks the budget before using the matches
+				if (budget != nullptr && budget->is_expired()) { return {}; }
+				const size_t version_pos = bucket.version_to_match[row];
+				const size_t version_idx = bucket.versions[version_pos];
+				for (size_t column = 0; column < ancestors_size; ++column)
+				{
+					const size_t ancestor_pos = bucket.ancestor_to_match[column];
+					const size_t ancestor_idx = bucket.ancestors[ancestor_pos];
+					// Note: edit costs are clamped to threshold, so edit costs exceeding it can be lower bounds
+					float cost;
+					if (use_bucket_cache && bucket.cache.contains_bound(version_pos, ancestor_pos) &&
+						(bucket.cache.contains(version_pos, ancestor_pos) ||
+						 bucket.cache.at(version_pos, ancestor_pos) > threshold))
+					{
+						cost = bucket.cache.at(version_pos, ancestor_pos);
+#ifdef ND_STATISTICS_ENABLED
+						++bucket_cache_hits;
+#endif
+					}
+					else
+					{
+						cost = evaluate_pair_cost(ancestor_idx, version_idx, cost_match, threshold);
+						if (use_bucket_cache && cost <= threshold)
+						{
+							bucket.cache.store(version_pos, ancestor_pos, cost);
+						}
+						else if (use_bucket_cache) { bucket.cache.store_bound(version_pos, ancestor_pos, cost); }
+#ifdef ND_STATISTICS_ENABLED
+						++bucket_cost_evaluations;
+						if (cost > threshold) { ++bucket_early_exits; }
+#endif
+					}
+					assert(cost >= 0 && "Negative cost not allowed");
+					pair_costs[row * ancestors_size + column] = cost;
+					costs[row * columns + column]			  = std::min(cost, threshold);
+				}
+			}
+#ifdef ND_STATISTICS_ENABLED
+			cost_cache_hits.fetch_add(bucket_cache_hits, std::memory_order_relaxed);
+			cost_evaluations.fetch_add(bucket_cost_evaluations, std::memory_order_relaxed);
+			early_exits.fetch_add(bucket_early_exits, std::memory_order_relaxed);
+#endif
+
+			std::vector<match_candidate> matches;
+			const std::vector<size_t> assignment = solve_assignment(costs, versions_size, columns);
+			for (size_t row = 0; row < versions_size; ++row)
+			{
+				const size_t column = assignment[row];
+				if (column >= ancestors_size || pair_costs[row * ancestors_size + column] >= threshold) { continue; }
+				matches.push_back({.cost		 = pair_costs[row * ancestors_size + column],
+								   .version_idx	 = bucket.versions[bucket.version_to_match[row]],
+								   .ancestor_idx = bucket.ancestors[bucket.ancestor_to_match[column]]});
+			}
+			return matches;
+		};
+
+		// Maximum number of times the assignment problems are solved before adding matches (if they do not converge)
+		constexpr size_t max_solutions = 10;
+		std::vector<std::vector<match_candidate>> buckets_matches, previous_buckets_matches;
+		bool has_new_matches = true;
+		while (has_new_matches && version_to_match_size > 0 && ancestor_to_match_size > 0 && !is_budget_expired())
+		{
+#ifdef ND_STATISTICS_ENABLED
+			++pass_iterations;
+#endif
+			buckets_matches.assign(buckets.size(), {});
+			previous_buckets_matches.assign(buckets.size(), {});
+			ref_match<RefType> tentative_match;
+			const ref_match<RefType>* cost_match = &match;
+			for (size_t solution = 0; solution < max_solutions; ++solution)
+			{
+				// Buckets are independent assignment problems
+				auto find_bucket_matches = [&](match_bucket& bucket) {
+					return find_optimal_matches(bucket, *cost_match);
+				};
+#if defined(ND_PARALLELIZE)
+				std::transform(std::execution::par, buckets.begin(), buckets.end(), buckets_matches.begin(),
+							   find_bucket_matches);
+#else
+				std::transform(buckets.begin(), buckets.end(), buckets_matches.begin(), find_bucket_matches);
+#endif
+				// If the budget expired the current solution could be partial: the last complete one is kept (the
+				// first solution is kept anyway, its buckets cut by the budget have no matches)
+				if (is_budget_expired() && solution > 0) { break; }
+				if (buckets_matches == previous_buckets_matches) { break; }
+
+				// Next solution uses the edit costs given by the current one
+				tentative_match = match;
+				for (const std::vector<match_candidate>& bucket_matches : buckets_matches)
+				{
+					for (const match_candidate& candidate : bucket_matches)
+					{
+						tentative_match.add_match(ancestor_ids[candidate.ancestor_idx],
+												  version_ids[candidate.version_idx]);
+					}
+				}
+				cost_match = &tentative_match;
+				std::swap(buckets_matches, previous_buckets_matches);
+			}
+
+			// Note: previous_buckets_matches stores the last solution
+			has_new_matches = false;
+			for (const std::vector<match_candidate>& bucket_matches : previous_buckets_matches)
+			{
+				for (const match_candidate& candidate : bucket_matches)
+				{
+					add_match(candidate);
+					invalidate_dependents(candidate.version_idx);
+					has_new_matches = true;
+				}
+			}
+		}
+	};
+
+	// Anchor engine: objects with the same key, unique among both the ancestor and the version objects to match, are
+	// matched if their edit cost is below threshold. Edit costs are evaluated knowing all such pairs, so that pairs
+	// referring to each other are not penalized for references not matched yet
+	auto run_anchor_pass = [&](const match_keys<RefType>* keys) {
+		if (keys == nullptr) { return; }
+		// Map a key to the index of the only object to match with that key (npos if many objects have that key)
+		std::unordered_map<size_t, size_t> ancestor_key_index, version_key_index;
+		auto index_key = [](std::unordered_map<size_t, size_t>& key_index,
+							const std::unordered_map<RefType, size_t>& object_keys, const RefType& object_id,
+							size_t object_idx) {
+			auto key = object_keys.find(object_id);
+			if (key == object_keys.end()) { return; }
+			auto [it, inserted] = key_index.try_emplace(key->second, object_idx);
+			if (!inserted) { it->second = match_candidate::npos; }
+		};
+		for (const match_bucket& bucket : buckets)
+		{
+			for (size_t ancestor_pos : bucket.ancestor_to_match)
+			{
+				const size_t ancestor_idx = bucket.ancestors[ancestor_pos];
+				index_key(ancestor_key_index, keys->ancestor, ancestor_ids[ancestor_idx], ancestor_idx);
+			}
+			for (size_t version_pos : bucket.version_to_match)
+			{
+				const size_t version_idx = bucket.versions[version_pos];
+				index_key(version_key_index, keys->version, version_ids[version_idx], version_idx);
+			}
+		}
+
+		// Pairs of objects with the same unique key
+		std::vector<match_candidate> anchors;
+		ref_match<RefType> anchor_match = match;
+		for (const auto& [key, version_idx] : version_key_index)
+		{
+			auto ancestor_key = ancestor_key_index.find(key);
+			if (version_idx == match_candidate::npos || ancestor_key == ancestor_key_index.end() ||
+				ancestor_key->second == match_candidate::npos)
+			{
+				continue;
+			}
+			anchors.push_back({.cost = 0, .version_idx = version_idx, .ancestor_idx = ancestor_key->second});
+			anchor_match.add_match(ancestor_ids[ancestor_key->second], version_ids[version_idx]);
+		}
+		// Note: sorted, so that anchors do not depend on keys order
+		std::sort(anchors.begin(), anchors.end());
+
+		auto evaluate_anchor_cost = [&](match_candidate& anchor) {
+			anchor.cost = evaluate_pair_cost(anchor.ancestor_idx, anchor.version_idx, anchor_match, threshold);
+		};
+#if defined(ND_PARALLELIZE)
+		std::for_each(std::execution::par, anchors.begin(), anchors.end(), evaluate_anchor_cost);
+#else
+		std::for_each(anchors.begin(), anchors.end(), evaluate_anchor_cost);
+#endif
+#ifdef ND_STATISTICS_ENABLED
+		++pass_iterations;
+		cost_evaluations.fetch_add(anchors.size(), std::memory_order_relaxed);
+		early_exits.fetch_add(std::count_if(anchors.begin(), anchors.end(),
+											[&](const match_candidate& anchor) { return anchor.cost > threshold; }),
+							  std::memory_order_relaxed);
+#endif
+		for (const match_candidate& anchor : anchors)
+		{
+			if (anchor.cost >= threshold) { continue; }
+			add_match(anchor);
+			invalidate_dependents(anchor.version_idx);
+		}
+	};
+
+	// Propagation engine: starting from the pairs matched so far, the neighbours still to match of a pair's ancestor
+	// and version objects are matched greedily among themselves (in increasing edit cost order, below threshold), then
+	// the new pairs are propagated in turn. Only pairs of neighbours are evaluated, so the number of evaluated pairs
+	// depends on the neighbourhoods of the objects to match, not on the number of objects
+	auto run_propagation_pass = [&](const match_neighbours<RefType>* neighbours) {
+		if (neighbours == nullptr) { return; }
+
+		// Matched <ancestor, version> pairs to propagate, initialized with the matches found so far (sorted, so that
+		// propagation does not depend on objects order)
+		std::vector<RefType> matched_version_ids;
+		for (const auto& [object_id, object] : version)
+		{
+			if (match.has_match_in_ancestor(object_id)) { matched_version_ids.push_back(object_id); }
+		}
+		std::sort(matched_version_ids.begin(), matched_version_ids.end());
+		std::deque<std::pair<RefType, RefType>> to_propagate;
+		for (const RefType& version_object_id : matched_version_ids)
+		{
+			to_propagate.emplace_back(match.to_ancestor(version_object_id), version_object_id);
+		}
+
+		// Indices of the neighbours of an object that are still to match
+		auto find_frontier = [](const std::unordered_map<RefType, std::vector<RefType>>& object_neighbours,
+								const RefType& object_id, const std::unordered_map<RefType, size_t>& object_index,
+								out_var std::vector<size_t>& frontier) {
+			frontier.clear();
+			auto it = object_neighbours.find(object_id);
+			if (it == object_neighbours.end()) { return; }
+			for (const RefType& neighbour_id : it->second)
+			{
+				auto neighbour_idx = object_index.find(neighbour_id);
+				if (neighbour_idx != object_index.end()) { frontier.push_back(neighbour_idx->second); }
+			}
+			// An object could be a neighbour many times
+			std::sort(frontier.begin(), frontier.end());
+			frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+		};
+		std::vector<size_t> ancestor_frontier, version_frontier;
+		std::vector<match_candidate> candidates;
+		while (!to_propagate.empty() && version_to_match_size > 0 && ancestor_to_match_size > 0 && !is_budget_expired())
+		{
+#ifdef ND_STATISTICS_ENABLED
+			++pass_iterations;
+#endif
+			const auto [ancestor_object_id, version_object_id] = to_propagate.front();
+			to_propagate.pop_front();
+			find_frontier(neighbours->ancestor, ancestor_object_id, ancestor_index, ancestor_frontier);
+			find_frontier(neighbours->version, version_object_id, version_index, version_frontier);
+
+			// Pairs of neighbours still to match, below threshold
+			candidates.clear();
+			for (size_t version_idx : version_frontier)
+			{
+				if (version_match[version_idx] != unmatched) { continue; }
+				for (size_t ancestor_idx : ancestor_frontier)
+				{
+					// Pairs of objects in different buckets have infinite edit cost
+					if (ancestor_match[ancestor_idx] != unmatched ||
+						ancestor_bucket[ancestor_idx] != version_bucket[version_idx])
+					{
+						continue;
+					}
+					const float cost = evaluate_pair_cost(ancestor_idx, version_idx, match, threshold);
+#ifdef ND_STATISTICS_ENABLED
+					cost_evaluations.fetch_add(1, std::memory_order_relaxed);
+					if (cost > threshold) { early_exits.fetch_add(1, std::memory_order_relaxed); }
+#endif
+					if (cost < threshold)
+					{
+						candidates.push_back({.cost = cost, .version_idx = version_idx, .ancestor_idx = ancestor_idx});
+					}
+				}
+			}
+
+			// Greedy assignment among the pairs of neighbours
+			std::sort(candidates.begin(), candidates.end());
+			for (const match_candidate& candidate : candidates)
+			{
+				if (ancestor_match[candidate.ancestor_idx] != unmatched ||
+					version_match[candidate.version_idx] != unmatched)
+				{
+					continue;
+				}
+				add_match(candidate);
+				invalidate_dependents(candidate.version_idx);
+				to_propagate.emplace_back(ancestor_ids[candidate.ancestor_idx], version_ids[candidate.version_idx]);
+			}
+		}
+	};
+
+	// Beam engine: each step extends each of the best beam_width partial matchings found so far (see nd::beam_state)
+	// with each of its beam_width best candidate matches below threshold, then it keeps the best beam_width extended
+	// partial matchings by total matching cost. Partial matchings without candidates are kept as they are, and the
+	// pass is over once none has candidates: the matches of the best partial matching are added to the match map.
+	// Note: ties are broken by the order of partial matchings and then by the order of candidates, hence a beam of
+	// width 1 finds the same matches of the greedy engines.
+	auto run_beam_pass = [&](size_t beam_width) {
+		beam_state<RefType> initial_state = {
+			.match = match, .ancestor_match = ancestor_match, .version_match = version_match};
+		initial_state.cost = ancestor_to_match_size + version_to_match_size;
+		initial_state.row_candidates.resize(version_ids.size() * beam_width);
+		initial_state.row_sizes.resize(version_ids.size(), 0);
+		initial_state.is_row_dirty.resize(version_ids.size(), true);
+		std::vector<beam_state<RefType>> beam = {std::move(initial_state)};
+
+		// Keep the beam_width best candidates in a max-heap, so that the worst one is replaced first
+		auto push_bounded = [beam_width](match_candidate* heap, size_t& heap_size, const match_candidate& candidate) {
+			if (heap_size < beam_width)
+			{
+				heap[heap_size++] = candidate;
+				std::push_heap(heap, heap + heap_size);
+			}
+			else if (candidate < heap[0])
+			{
+				std::pop_heap(heap, heap + heap_size);
+				heap[heap_size - 1] = candidate;
+				std::push_heap(heap, heap + heap_size);
+			}
+		};
+
+		// Search the beam_width best candidates below threshold of a version object in a partial matching
+		auto find_row_candidates = [&](beam_state<RefType>& state, const match_bucket& bucket, size_t version_pos) {
+			const size_t version_idx = bucket.versions[version_pos];
+			match_candidate* row	 = state.row_candidates.data() + version_idx * beam_width;
+			size_t& row_size		 = state.row_sizes[version_idx];
+			row_size				 = 0;
+#ifdef ND_STATISTICS_ENABLED
+			size_t row_cost_evaluations = 0, row_early_exits = 0;
+#endif
+			const bool is_pruned = !has_candidates.empty() && has_candidates[version_idx];
+			for (size_t ancestor_pos : is_pruned ? candidate_positions[version_idx] : bucket.ancestor_to_match)
+			{
+				const size_t ancestor_idx = bucket.ancestors[ancestor_pos];
+				if (state.ancestor_match[ancestor_idx] != unmatched) { continue; }
+				// Only candidates below threshold and better than the worst one in a full row are of interest
+				const float bound = row_size < beam_width ? threshold : std::min(row[0].cost, threshold);
+				const float cost  = evaluate_pair_cost(ancestor_idx, version_idx, state.match, bound);
+#ifdef ND_STATISTICS_ENABLED
+				++row_cost_evaluations;
+				if (cost > bound) { ++row_early_exits; }
+#endif
+				if (cost >= threshold) { continue; }
+				push_bounded(row, row_size, {.cost = cost, .version_idx = version_idx, .ancestor_idx = ancestor_idx});
+			}
+			std::sort_heap(row, row + row_size);
+			state.is_row_dirty[version_idx] = false;
+#ifdef ND_STATISTICS_ENABLED
+			cost_evaluations.fetch_add(row_cost_evaluations, std::memory_order_relaxed);
+			early_exits.fetch_add(row_early_exits, std::memory_order_relaxed);
+#endif
+		};
+
+		// Find the beam_width best candidates below threshold of a partial matching (sorted by edit cost), searching
+		// again its dirty rows
+		auto find_state_candidates = [&](beam_state<RefType>& state, std::vector<match_candidate>& candidates) {
+			candidates.resize(beam_width);
+			size_t candidates_size = 0;
+			for (const match_bucket& bucket : buckets)
+			{
+				for (size_t version_pos : bucket.version_to_match)
+				{
+					const size_t version_idx = bucket.versions[version_pos];
+					if (state.version_match[version_idx] != unmatched) { continue; }
+					if (state.is_row_dirty[version_idx]) { find_row_candidates(state, bucket, version_pos); }
+					const match_candidate* row = state.row_candidates.data() + version_idx * beam_width;
+					for (size_t i = 0; i < state.row_sizes[version_idx]; ++i)
+					{
+						push_bounded(candidates.data(), candidates_size, row[i]);
+					}
+				}
+			}
+			std::sort_heap(candidates.begin(), candidates.begin() + candidates_size);
+			candidates.resize(candidates_size);
+		};
+
+		// Extend a partial matching with a candidate match, marking as dirty the rows it could have changed
+		auto extend_state = [&](beam_state<RefType>& state, const match_candidate& candidate, float cost, size_t key) {
+			state.match.add_match(ancestor_ids[candidate.ancestor_idx], version_ids[candidate.version_idx]);
+			state.ancestor_match[candidate.ancestor_idx] = static_cast<int32_t>(candidate.version_idx);
+			state.version_match[candidate.version_idx]	 = static_cast<int32_t>(candidate.ancestor_idx);
+			state.matches.push_back(candidate);
+			state.cost = cost;
+			state.key  = key;
+
+			if (!use_cache)
+			{
+				std::fill(state.is_row_dirty.begin(), state.is_row_dirty.end(), true);
+				return;
+			}
+			// Rows whose best candidates include the newly matched ancestor object
+			for (size_t version_idx = 0; version_idx < version_ids.size(); ++version_idx)
+			{
+				if (state.version_match[version_idx] != unmatched || state.is_row_dirty[version_idx]) { continue; }
+				const match_candidate* row = state.row_candidates.data() + version_idx * beam_width;
+				for (size_t i = 0; i < state.row_sizes[version_idx]; ++i)
+				{
+					if (row[i].ancestor_idx == candidate.ancestor_idx) { state.is_row_dirty[version_idx] = true; }
+				}
+			}
+			// Rows of the objects depending on the newly matched version object
+			for (size_t dependent_idx : version_dependents[candidate.version_idx])
+			{
+				state.is_row_dirty[dependent_idx] = true;
+			}
+		};
+
+		// An extension of a partial matching with one of its candidates (or with no candidate, if it has none)
+		struct beam_extension
+		{
+			float cost;
+			size_t state_idx;
+			match_candidate candidate;
+			size_t key;
+
+			bool operator<(const beam_extension& other) const
+			{
+				return std::tie(cost, state_idx, candidate) < std::tie(other.cost, other.state_idx, other.candidate);
+			}
+		};
+		std::vector<std::vector<match_candidate>> beam_candidates;
+		std::vector<beam_extension> extensions;
+		std::vector<size_t> state_indices;
+		while (!is_budget_expired())
+		{
+#ifdef ND_STATISTICS_ENABLED
+			++pass_iterations;
+#endif
+			// Candidates of each partial matching are searched independently
+			beam_candidates.resize(beam.size());
+			state_indices.resize(beam.size());
+			std::iota(state_indices.begin(), state_indices.end(), 0);
+#if defined(ND_PARALLELIZE)
+			std::for_each(std::execution::par, state_indices.begin(), state_indices.end(), [&](size_t state_idx) {
+				find_state_candidates(beam[state_idx], beam_candidates[state_idx]);
+			});
+#else
+			for (size_t state_idx : state_indices)
+			{
+				find_state_candidates(beam[state_idx], beam_candidates[state_idx]);
+			}
+#endif
+			// Budget could have expired while searching candidates
+			if (is_budget_expired()) { break; }
+
+			extensions.clear();
+			bool is_extended = false;
+			for (size_t state_idx = 0; state_idx < beam.size(); ++state_idx)
+			{
+				const beam_state<RefType>& state = beam[state_idx];
+				if (beam_candidates[state_idx].empty())
+				{
+					extensions.push_back({.cost = state.cost, .state_idx = state_idx, .key = state.key});
+					continue;
+				}
+				is_extended = true;
+				for (const match_candidate& candidate : beam_candidates[state_idx])
+				{
+					const size_t pair_key =
+						mix_hash(candidate.ancestor_idx * version_ids.size() + candidate.version_idx);
+					extensions.push_back({.cost		 = (state.cost - 2.0f) + candidate.cost,
+										  .state_idx = state_idx,
+										  .candidate = candidate,
+										  .key		 = state.key + pair_key});
+				}
+			}
+			if (!is_extended) { break; }
+
+			// Keep the best beam_width extensions, discarding the ones with the same matches of a better one
+			std::sort(extensions.begin(), extensions.end());
+			std::vector<beam_state<RefType>> next_beam;
+			std::unordered_set<size_t> next_keys;
+			for (const beam_extension& extension : extensions)
+			{
+				if (next_beam.size() == beam_width) { break; }
+				if (!next_keys.insert(extension.key).second) { continue; }
+				next_beam.push_back(beam[extension.state_idx]);
+				if (extension.candidate.version_idx != match_candidate::npos)
+				{
+					extend_state(next_beam.back(), extension.candidate, extension.cost, extension.key);
+				}
+			}
+			beam = std::move(next_beam);
+		}
+
+		// Partial matchings are sorted by total matching cost, the first one is the best
+		for (const match_candidate& candidate : beam.front().matches)
+		{
+			add_match(candidate);
+			invalidate_dependents(candidate.version_idx);
+		}
+	};
+
+	// Perform passes as long as there are objects to match
+	for (const basic_match_pass<RefType, CostFn>& pass : match_passes)
+	{
+		if (version_to_match_size == 0 || ancestor_to_match_size == 0 || is_budget_expired()) { break; }
+		cost_fn	  = &pass.cost_fn;
+		threshold = pass.threshold;
+		candidate_positions.assign(pass.candidates ? version_ids.size() : 0, {});
+		has_candidates.assign(pass.candidates ? version_ids.size() : 0, false);
+		if (pass.candidates)
+		{
+			for (const auto& [version_object_id, candidate_ids] : *pass.candidates)
+			{
+				auto version_idx = version_index.find(version_object_id);
+				if (version_idx == version_index.end()) { continue; }
+				has_candidates[version_idx->second] = true;
+				std::vector<size_t>& positions		= candidate_positions[version_idx->second];
+				for (const RefType& candidate_id : candidate_ids)
+				{
+					// Candidate ancestor objects already matched, or in another bucket, can't be matched
+					auto ancestor_idx = ancestor_index.find(candidate_id);
+					if (ancestor_idx == ancestor_index.end() ||
+						ancestor_bucket[ancestor_idx->second] != version_bucket[version_idx->second])
+					{
+						continue;
+					}
+					positions.push_back(ancestor_position[ancestor_idx->second]);
+				}
+				// Note: sorted, so that ties keep the lowest ancestor index (as for all the ancestor objects)
+				std::sort(positions.begin(), positions.end());
+				positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+			}
+		}
+		// Edit costs evaluated in previous passes used a different edit cost function
+		for (match_bucket& bucket : buckets)
+		{
+			if (use_cache) { bucket.cache.clear(); }
+			bucket.is_dirty = true;
+		}
+#ifdef ND_STATISTICS_ENABLED
+		nd::timer pass_timer;
+		const int pass_matched				  = matched;
+		const size_t pass_cost_cache_hits	  = cost_cache_hits.load();
+		const size_t pass_cost_evaluations	  = cost_evaluations.load();
+		const size_t pass_early_exits		  = early_exits.load();
+		const size_t pass_zero_cost_shortcuts = zero_cost_shortcuts.load();
+		pass_iterations						  = 0;
+#endif
+
+		switch (pass.engine)
+		{
+		case match_engine::scan: run_scan_pass(); break;
+		case match_engine::heap:
+			// Heap engine needs dependents for knowing which candidates have to be evaluated again
+			if (use_cache) { run_heap_pass(); }
+			else
+			{
+				run_scan_pass();
+			}
+			break;
+		case match_engine::optimal: run_optimal_pass(); break;
+		case match_engine::anchor: run_anchor_pass(pass.keys); break;
+		case match_engine::propagation: run_propagation_pass(pass.neighbours); break;
+		case match_engine::beam:
+			// Beam of width 1 is greedy, hence the same matches are found (faster) by the scan engine
+			if (pass.beam_width > 1) { run_beam_pass(pass.beam_width); }
+			else
+			{
+				run_scan_pass();
+			}
+			break;
+		}
+#ifdef ND_STATISTICS_ENABLED
+		pass_timer.stop();
+		nd::json pass_statistics;
+		pass_statistics["engine"]			   = static_cast<int>(pass.engine);
+		pass_statistics["threshold"]		   = pass.threshold;
+		pass_statistics["time"]				   = pass_timer.milliseconds();
+		pass_statistics["iterations"]		   = pass_iterations;
+		pass_statistics["matches"]			   = matched - pass_matched;
+		pass_statistics["cost_cache_hits"]	   = cost_cache_hits.load() - pass_cost_cache_hits;
+		pass_statistics["cost_evaluations"]	   = cost_evaluations.load() - pass_cost_evaluations;
+		pass_statistics["early_exits"]		   = early_exits.load() - pass_early_exits;
+		pass_statistics["zero_cost_shortcuts"] = zero_cost_shortcuts.load() - pass_zero_cost_shortcuts;
+		match_statistics["passes"].push_back(pass_statistics);
+#endif
+	}
+#ifdef ND_STATISTICS_ENABLED
+	timer.stop();
+	// Matching cost of the final matches, i.e. with edit costs evaluated knowing all the matches (initial matches have
+	// zero cost)
+	float final_match_cost = ancestor_to_match_size + version_to_match_size;
+	for (size_t version_idx = 0; version_idx < version_ids.size(); ++version_idx)
+	{
+		if (version_match[version_idx] == unmatched) { continue; }
+		final_match_cost += evaluate_pair_cost(version_match[version_idx], version_idx, match);
+	}
+	match_statistics["final_match_cost"]	= final_match_cost;
+	match_statistics["time"]				= timer.milliseconds();
+	match_statistics["match_map_size"]		= ancestor.size() - ancestor_ids.size() + matched;
+	match_statistics["total_match_cost"]	= step_total_match_cost;
+	match_statistics["buckets"]				= buckets.size();
+	match_statistics["degraded"]			= match.is_degraded();
+	match_statistics["cost_cache_hits"]		= cost_cache_hits.load();
+	match_statistics["cost_evaluations"]	= cost_evaluations.load();
+	match_statistics["early_exits"]			= early_exits.load();
+	match_statistics["zero_cost_shortcuts"]	= zero_cost_shortcuts.load();
+	if (call_statistics != nullptr) { call_statistics->add(match_statistics); }
+	{
+		auto& statistics = nd::statistics_collector::instance();
+		std::lock_guard lock(statistics.mutex);
+		statistics.json["matches"].push_back(match_statistics);
+	}
+#endif
+	return match;
+}
+
+/*
+ * Matching algorithm described in NodeGit's paper work (only one pass is performed).
+ * Given an ancestor and version unordered collection of objects (general implementation), it finds greedly
+ * the best match between those two collections' objects.
+ *
+ * Template parameters:
+ *	- RefType: type of references to match
  *	- MapContainer: type of the unordered collection container (it shall be a Map-like container, i.e. it shall store
 					key-value pairs)
  *
  * Function parameters:
- *	- ancestor: unordered collection of ancestor <id, object> pairs
- *	- version: unordered collection of version <id, object> pairs
- *	- cost_fn: edit cost function to use
- *	- threshold: threshold to use for early stopping
+ *	- ancestor: unordered collection of ancestor <id, object> pairs
+ *	- version: unordered collection of version <id, object> pairs
+ *	- cost_fn: edit cost function to use
+ *	- threshold: threshold to use for early stopping
+ *	- dependents: map of dependent version objects used for caching edit costs (see the multi-pass version)
+ *	- bucket_fn: function returning the bucket key of an object (see the multi-pass version)
+ *
+ * Returns: bidirectional map containing matched objects ids.
+ */
+template <typename RefType, typename MapContainer, typename = std::enable_if_t<nd::is_mapping_v<MapContainer>>>
+static ref_match<RefType> match_objects(const MapContainer& ancestor, const MapContainer& version,
+										const cost_fn<RefType>& cost_fn, float threshold,
+										const std::unordered_map<RefType, std::vector<RefType>>* dependents = nullptr,
+										const bucket_fn<typename MapContainer::mapped_type>& bucket_fn = nullptr)
+{
+	// Create first pass
+	std::vector<match_pass<RefType>> passes = {{.cost_fn = cost_fn, .threshold = threshold}};
+	// Call matching algorithm
+	return match_objects(ancestor, version, passes, dependents, bucket_fn);
+}
+
+/*
+ * Hash of a <property name, property> pair of a node.
+ * Note: symbols are hashed by name (see nd::symbol::name_hash), so that hashes do not depend on interning order.
+ */
+template <typename PropertyType>
+static size_t property_hash(const std::string& property_name, const PropertyType& property)
+{
+	size_t seed = 0;
+	hash_combine(seed, property_name, property);
+	return seed;
+}
+template <typename PropertyType>
+static size_t property_hash(const symbol& property_name, const PropertyType& property)
+{
+	size_t seed = 0;
+	hash_combine(seed, property_name.name_hash(), property);
+	return seed;
+}
+
+/*
+ * Fingerprint of a node, namely a hash of its type, values, texture references and references to other nodes/graphs.
+ * References of version nodes are mapped to the matched ancestor references, so that two nodes with the same
+ * fingerprint (most likely) have zero edit cost.
+ * Note: properties' hashes are combined by sum, so that the fingerprint does not depend on properties order.
+ *
+ * Function parameters:
+ *	- node: node to fingerprint
+ *	- graph_matches: graph matches used for mapping graph references (nullptr if references must not be mapped)
+ *	- node_matches: node matches used for mapping node references (nullptr if references must not be mapped)
+ *	- fingerprint: output fingerprint
+ *
+ * Returns: false if some reference has no match yet (i.e. the fingerprint can't be computed), true otherwise.
+ */
+static bool node_fingerprint(const node& node, const ref_match<graph_ref>* graph_matches,
+							 const ref_match<node_ref>* node_matches, out_var size_t& fingerprint)
+{
+	size_t values_hash = 0;
+	for (const auto& [property_name, value] : node.node_values)
+	{
+		values_hash += property_hash(property_name, value);
+	}
+
+	size_t textures_hash = 0;
+	for (const auto& [property_name, texture_reference] : node.texture_references)
+	{
+		size_t texture_hash = 0;
+		for (const auto& [texture_property_name, value] : texture_reference)
+		{
+			texture_hash += property_hash(texture_property_name, value);
+		}
+		textures_hash += property_hash(property_name, texture_hash);
+	}
+
+	size_t graph_references_hash = 0;
+	for (const auto& [property_name, graph_reference] : node.graph_references)
+	{
+		if (!graph_matches) { graph_references_hash += property_hash(property_name, graph_reference); }
+		else if (graph_matches->has_match_in_ancestor(graph_reference))
+		{
+			graph_references_hash += property_hash(property_name, graph_matches->to_ancestor(graph_reference));
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	size_t node_references_hash = 0;
+	for (const auto& [property_name, node_reference] : node.node_references)
+	{
+		if (!node_matches) { node_references_hash += property_hash(property_name, node_reference); }
+		else if (node_matches->has_match_in_ancestor(node_reference))
+		{
+			node_references_hash += property_hash(property_name, node_matches->to_ancestor(node_reference));
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	size_t input_references_hash = 0;
+	for (const auto& [socket_name, input_reference] : node.input_references)
+	{
+		if (!node_matches) { input_references_hash += property_hash(socket_name, input_reference); }
+		else if (node_matches->has_match_in_ancestor(input_reference.node))
+		{
+			const edge matched_input_reference = {.node		   = node_matches->to_ancestor(input_reference.node),
+												  .socket_name = input_reference.socket_name};
+			input_references_hash += property_hash(socket_name, matched_input_reference);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	fingerprint = 0;
+	hash_combine(fingerprint, get_node_type(node), values_hash, textures_hash, graph_references_hash,
+				 node_references_hash, input_references_hash);
+	return true;
+}
+
+/*
+ * Summary of a graph, computed once before matching graphs so that graph edit costs are evaluated without visiting
+ * graphs' nodes:
+ *	- type_histogram: number of nodes for each node type id (type ids are shared by the graphs being matched)
+ *	- node_count: number of nodes
+ *	- content_hash: sum of the hashes of nodes' ids and fingerprints (see nd::node_fingerprint)
+ */
+struct graph_signature
+{
+	std::vector<int> type_histogram;
+	size_t node_count;
+	size_t content_hash;
+
+	bool operator==(const graph_signature& other) const = default;
+};
+
+/*
+ * Summarises a graph into its signature (see nd::graph_signature).
+ *
+ * Function parameters:
+ *	- graph: graph to summarise
+ *	- type_ids: map from a node type to its id (node types not in the map are added to it)
+ *
+ * Returns: the signature of the graph.
+ */
+static graph_signature make_graph_signature(const graph& graph, std::unordered_map<std::string, size_t>& type_ids)
+{
+	graph_signature signature{.type_histogram = {}, .node_count = graph.nodes.size(), .content_hash = 0};
+	for (const auto& [node_id, node] : graph.nodes)
+	{
+		const size_t type_id = type_ids.try_emplace(get_node_type(node), type_ids.size()).first->second;
+		if (type_id >= signature.type_histogram.size()) { signature.type_histogram.resize(type_id + 1, 0); }
+		++signature.type_histogram[type_id];
+
+		size_t fingerprint;
+		node_fingerprint(node, nullptr, nullptr, fingerprint);
+		size_t node_hash = 0;
+		hash_combine(node_hash, node_id, fingerprint);
+		signature.content_hash += node_hash;
+	}
+	return signature;
+}
+
+/*
+ * Graph edit cost between two graph signatures: the L1 distance between their type histograms, normalized by the
+ * number of ancestor nodes.
+ */
+static float edit_cost(const graph_signature& ancestor, const graph_signature& version)
+{
+	const std::vector<int>& ancestor_histogram = ancestor.type_histogram;
+	const std::vector<int>& version_histogram  = version.type_histogram;
+	const size_t common_size				   = std::min(ancestor_histogram.size(), version_histogram.size());
+	int cost								   = 0;
+	for (size_t type_id = 0; type_id < common_size; ++type_id)
+	{
+		cost += std::abs(ancestor_histogram[type_id] - version_histogram[type_id]);
+	}
+	// Types missing from a histogram have zero nodes
+	cost = std::accumulate(ancestor_histogram.begin() + common_size, ancestor_histogram.end(), cost);
+	cost = std::accumulate(version_histogram.begin() + common_size, version_histogram.end(), cost);
+	// Normalize cost
+	return cost / static_cast<float>(ancestor.node_count);
+}
+
+/*
+ * Graph edit cost function described in NodeGit's paper work.
+ * Note: this function is used by the matching algorithm for obtaining a nd::ref_match<graph_ref> object, namely
+ * a matching between graphs of two scripts.
+ *
+ * Function parameters:
+ *	- ancestor: ancestor graph
+ *	- version: version graph
  *
- * Returns: bidirectional map containing matched objects ids.
+ * Returns: the cost required for editing the ancestor graph so to be the version graph. Edit cost is normalized in the
+			range [0, 1] (actually it can be >=1, but it can be clamped to 1).
  */
-template <typename RefType, typename MapContainer, typename = std::enable_if_t<nd::is_mapping_v<MapContainer>>>
-static ref_match<RefType> match_objects(const MapContainer& ancestor, const MapContainer& version,
-										const cost_fn<RefType>& cost_fn, float threshold)
+float edit_cost(const graph& ancestor, const graph& version)
 {
-	// Create first pass
-	std::vector<match_pass<RefType>> passes = {{.cost_fn = cost_fn, .threshold = threshold}};
-	// Call matching algorithm
-	return match_objects(ancestor, version, passes);
+	std::unordered_map<std::string, size_t> type_ids;
+	return edit_cost(make_graph_signature(ancestor, type_ids), make_graph_signature(version, type_ids));
+}
+
+/*
+ * Prematching of graphs with identical signatures (see nd::graph_signature), performed in linear time before the
+ * matching algorithm. An ancestor and a version graph are prematched if they have the same signature and their content
+ * hash is unique among both the ancestor and the version graphs.
+ *
+ * Function parameters:
+ *	- ancestor_signatures: map from an ancestor graph id to its signature
+ *	- version_signatures: map from a version graph id to its signature
+ *
+ * Returns: bidirectional map containing prematched graphs ids.
+ */
+static ref_match<graph_ref> prematch_graphs(const std::unordered_map<graph_ref, graph_signature>& ancestor_signatures,
+											const std::unordered_map<graph_ref, graph_signature>& version_signatures)
+{
+	// Graphs grouped by content hash
+	std::unordered_map<size_t, std::vector<graph_ref>> ancestor_hashes, version_hashes;
+	for (const auto& [graph_id, signature] : ancestor_signatures)
+	{
+		ancestor_hashes[signature.content_hash].push_back(graph_id);
+	}
+	for (const auto& [graph_id, signature] : version_signatures)
+	{
+		version_hashes[signature.content_hash].push_back(graph_id);
+	}
+
+	ref_match<graph_ref> match = {};
+	for (const auto& [content_hash, version_graphs] : version_hashes)
+	{
+		auto ancestor_graphs = ancestor_hashes.find(content_hash);
+		if (version_graphs.size() != 1 || ancestor_graphs == ancestor_hashes.end() ||
+			ancestor_graphs->second.size() != 1)
+		{
+			continue;
+		}
+		// Different graphs could have the same content hash (i.e. hash collision)
+		const graph_ref& ancestor_graph_id = ancestor_graphs->second.front();
+		const graph_ref& version_graph_id  = version_graphs.front();
+		if (ancestor_signatures.at(ancestor_graph_id) == version_signatures.at(version_graph_id))
+		{
+			match.add_match(ancestor_graph_id, version_graph_id);
+		}
+	}
+	return match;
 }
 
 /*
@@ -296,18 +1855,483 @@ static ref_match<RefType> match_objects(const MapContainer& ancestor, const MapC
  * Function parameters:
  *	- ancestor: ancestor script
  *	- version: version script
+ *	- engine: engine used for finding the matches (see nd::match_engine)
+ *	- budget: budget of the matching (see nd::match_budget), nullptr if there's no budget
  *
  * Returns: bidirectional map containing matched graphs ids.
  */
-ref_match<graph_ref> match_graphs(const script& ancestor, const script& version)
+ref_match<graph_ref> match_graphs(const script& ancestor, const script& version, match_engine engine,
+								  const match_budget* budget)
 {
+#ifdef ND_STATISTICS_ENABLED
+	nd::timer timer;
+	match_call_statistics call_statistics;
+	match_call_statistics* const call_statistics_ptr = &call_statistics;
+#else
+	match_call_statistics* const call_statistics_ptr = nullptr;
+#endif
+	// Summarise each graph once, so that graph edit costs are evaluated between graph signatures
+	std::unordered_map<std::string, size_t> type_ids;
+	std::unordered_map<graph_ref, graph_signature> ancestor_signatures, version_signatures;
+	for (const auto& [graph_id, graph] : ancestor.graphs)
+	{
+		ancestor_signatures.emplace(graph_id, make_graph_signature(graph, type_ids));
+	}
+	for (const auto& [graph_id, graph] : version.graphs)
+	{
+		version_signatures.emplace(graph_id, make_graph_signature(graph, type_ids));
+	}
 	// Create graph edit cost function
 	auto cost_fn = [&](const graph_ref& ancestor_graph_id, const graph_ref& version_graph_id,
 					   const ref_match<graph_ref>& graph_matches) -> float {
-		return edit_cost(get_graph(ancestor, ancestor_graph_id), get_graph(version, version_graph_id));
+		return edit_cost(ancestor_signatures.at(ancestor_graph_id), version_signatures.at(version_graph_id));
 	};
+	// Graph edit cost does not depend on matches, hence no graph has dependents
+	const std::unordered_map<graph_ref, std::vector<graph_ref>> dependents = {};
+	// Graphs with identical signatures are prematched, only the remaining ones are matched by the matching algorithm
+	ref_match<graph_ref> prematch = prematch_graphs(ancestor_signatures, version_signatures);
 	// Call matching algorithm (single-pass)
-	return match_objects<graph_ref>(ancestor.graphs, version.graphs, cost_fn, 0.65f);
+	std::vector<basic_match_pass<graph_ref, decltype(cost_fn)>> passes = {
+		{.cost_fn = cost_fn, .threshold = 0.65f, .engine = engine}};
+	ref_match<graph_ref> match = match_objects<graph_ref>(ancestor.graphs, version.graphs, passes, &dependents, nullptr,
+														  std::move(prematch), budget, call_statistics_ptr);
+#ifdef ND_STATISTICS_ENABLED
+	timer.stop();
+	call_statistics.collect("match_graphs", ancestor.graphs.size(), version.graphs.size(), timer.milliseconds());
+#endif
+	return match;
+}
+
+/*
+ * Prematching of nodes with identical content, performed in (almost) linear time before the matching algorithm.
+ * An ancestor and a version node are prematched if they have the same fingerprint (see nd::node_fingerprint), their
+ * fingerprint is unique among both the ancestor and the version nodes still to match, and their edit cost is zero.
+ * A version node referring to nodes not matched yet can't be fingerprinted: it is fingerprinted again once the nodes
+ * it refers to get matched, so identical subgraphs are prematched starting from their source nodes.
+ *
+ * Function parameters:
+ *	- ancestor: ancestor graph
+ *	- version: version graph
+ *	- graph_matches: bidirectional map of already matched graphs
+ *	- dependents: map from a version node id to the ids of the version nodes referring to it
+ *	- cost_fn: node edit cost function
+ *
+ * Returns: bidirectional map containing prematched nodes ids.
+ */
+static ref_match<node_ref> prematch_nodes(const graph& ancestor, const graph& version,
+										  const ref_match<graph_ref>& graph_matches,
+										  const std::unordered_map<node_ref, std::vector<node_ref>>& dependents,
+										  const cost_fn<node_ref>& cost_fn)
+{
+	ref_match<node_ref> match = {};
+	// Add match between invalid references (because they're the same in all versions)
+	match.add_match(node_ref::invalid_ref, node_ref::invalid_ref);
+
+	// Ancestor nodes to match grouped by fingerprint (ancestor references are not mapped)
+	std::unordered_map<size_t, std::vector<node_ref>> ancestor_fingerprints;
+	for (const auto& [node_id, node] : ancestor.nodes)
+	{
+		size_t fingerprint;
+		node_fingerprint(node, nullptr, nullptr, fingerprint);
+		ancestor_fingerprints[fingerprint].push_back(node_id);
+	}
+
+	// Version nodes to match grouped by fingerprint (only the ones fingerprinted so far)
+	std::unordered_map<size_t, std::vector<node_ref>> version_fingerprints;
+	std::vector<node_ref> to_fingerprint;
+	to_fingerprint.reserve(version.nodes.size());
+	for (const auto& [node_id, node] : version.nodes)
+	{
+		to_fingerprint.push_back(node_id);
+	}
+	// Note: sorted, so that prematching does not depend on nodes order
+	std::sort(to_fingerprint.begin(), to_fingerprint.end());
+
+	std::vector<size_t> fingerprints;
+	while (!to_fingerprint.empty())
+	{
+		// Fingerprint the version nodes whose references are all matched
+		fingerprints.clear();
+		for (const node_ref& node_id : to_fingerprint)
+		{
+			size_t fingerprint;
+			if (node_fingerprint(get_node(version, node_id), &graph_matches, &match, fingerprint))
+			{
+				version_fingerprints[fingerprint].push_back(node_id);
+				fingerprints.push_back(fingerprint);
+			}
+		}
+
+		// Prematch nodes with unique fingerprints, the nodes referring to them could be fingerprinted now
+		to_fingerprint.clear();
+		for (size_t fingerprint : fingerprints)
+		{
+			std::vector<node_ref>& version_nodes = version_fingerprints.at(fingerprint);
+			auto ancestor_nodes					 = ancestor_fingerprints.find(fingerprint);
+			if (version_nodes.size() != 1 || ancestor_nodes == ancestor_fingerprints.end() ||
+				ancestor_nodes->second.size() != 1)
+			{
+				continue;
+			}
+			// Different nodes could have the same fingerprint (i.e. hash collision)
+			const node_ref& ancestor_node_id = ancestor_nodes->second.front();
+			const node_ref& version_node_id	 = version_nodes.front();
+			if (cost_fn(ancestor_node_id, version_node_id, match) != 0) { continue; }
+
+			match.add_match(ancestor_node_id, version_node_id);
+			if (dependents.contains(version_node_id))
+			{
+				const std::vector<node_ref>& node_dependents = dependents.at(version_node_id);
+				to_fingerprint.insert(to_fingerprint.end(), node_dependents.begin(), node_dependents.end());
+			}
+			ancestor_nodes->second.clear();
+			version_nodes.clear();
+		}
+		// A node could refer to many of the newly matched nodes
+		std::sort(to_fingerprint.begin(), to_fingerprint.end());
+		to_fingerprint.erase(std::unique(to_fingerprint.begin(), to_fingerprint.end()), to_fingerprint.end());
+	}
+	return match;
+}
+
+/*
+ * Weisfeiler-Lehman style structural hashes of a graph's nodes. The hash of a node is initialized with the hash of its
+ * type, then at each round the hashes of the nodes it refers to (by input and node references) and of the nodes
+ * referring to it are combined into its hash, so that after n rounds it describes the node's neighbourhood up to
+ * distance n.
+ * Note: neither node ids nor values are hashed, hence renamed nodes and nodes whose values changed keep their hash.
+ *
+ * Function parameters:
+ *	- graph: graph whose nodes are hashed
+ *	- rounds: number of rounds
+ *
+ * Returns: map from a node id to its structural hash.
+ */
+static std::unordered_map<node_ref, size_t> structural_hashes(const graph& graph, size_t rounds)
+{
+	std::vector<node_ref> node_ids;
+	node_ids.reserve(graph.nodes.size());
+	std::unordered_map<node_ref, size_t> node_index;
+	std::vector<size_t> hashes;
+	hashes.reserve(graph.nodes.size());
+	for (const auto& [node_id, node] : graph.nodes)
+	{
+		node_index.emplace(node_id, node_ids.size());
+		node_ids.push_back(node_id);
+		hashes.push_back(std::hash<std::string>()(get_node_type(node)));
+	}
+
+	// Neighbours of each node, namely <hash of the reference's property/socket names, neighbour index> pairs
+	std::vector<std::vector<std::pair<size_t, size_t>>> referred(node_ids.size()), referring(node_ids.size());
+	auto add_reference = [&](size_t node_idx, const node_ref& referred_id, size_t reference_hash) {
+		auto referred_idx = node_index.find(referred_id);
+		if (referred_idx == node_index.end()) { return; }
+		referred[node_idx].emplace_back(reference_hash, referred_idx->second);
+		referring[referred_idx->second].emplace_back(reference_hash, node_idx);
+	};
+	for (size_t node_idx = 0; node_idx < node_ids.size(); ++node_idx)
+	{
+		const node& node = get_node(graph, node_ids[node_idx]);
+		for (const auto& [socket_name, input_reference] : node.input_references)
+		{
+			size_t reference_hash = 0;
+			hash_combine(reference_hash, socket_name.name_hash(), input_reference.socket_name.name_hash());
+			add_reference(node_idx, input_reference.node, reference_hash);
+		}
+		for (const auto& [property_name, node_reference] : node.node_references)
+		{
+			add_reference(node_idx, node_reference, property_name.name_hash());
+		}
+	}
+
+	// Note: neighbours' hashes are combined by sum, so that hashes do not depend on references order
+	std::vector<size_t> next_hashes(node_ids.size());
+	auto neighbours_hash = [&](const std::vector<std::pair<size_t, size_t>>& neighbours) -> size_t {
+		size_t hash = 0;
+		for (const auto& [reference_hash, neighbour_idx] : neighbours)
+		{
+			size_t neighbour_hash = 0;
+			hash_combine(neighbour_hash, reference_hash, hashes[neighbour_idx]);
+			hash += neighbour_hash;
+		}
+		return hash;
+	};
+	for (size_t round = 0; round < rounds; ++round)
+	{
+		for (size_t node_idx = 0; node_idx < node_ids.size(); ++node_idx)
+		{
+			next_hashes[node_idx] = hashes[node_idx];
+			hash_combine(next_hashes[node_idx], neighbours_hash(referred[node_idx]),
+						 neighbours_hash(referring[node_idx]));
+		}
+		std::swap(hashes, next_hashes);
+	}
+
+	std::unordered_map<node_ref, size_t> node_hashes;
+	node_hashes.reserve(node_ids.size());
+	for (size_t node_idx = 0; node_idx < node_ids.size(); ++node_idx)
+	{
+		node_hashes.emplace(node_ids[node_idx], hashes[node_idx]);
+	}
+	return node_hashes;
+}
+
+/*
+ * Neighbours of a graph's nodes through input references, namely the nodes each node takes inputs from and the nodes
+ * taking inputs from it.
+ */
+static std::unordered_map<node_ref, std::vector<node_ref>> input_reference_neighbours(const graph& graph)
+{
+	std::unordered_map<node_ref, std::vector<node_ref>> neighbours;
+	for (const auto& [node_id, node] : graph.nodes)
+	{
+		for (const auto& [socket_name, input_reference] : node.input_references)
+		{
+			if (input_reference.node == node_ref::invalid_ref) { continue; }
+			neighbours[node_id].push_back(input_reference.node);
+			neighbours[input_reference.node].push_back(node_id);
+		}
+	}
+	return neighbours;
+}
+
+/*
+ * Features of a node hashed by MinHash signatures (see nd::minhash_candidates): the hashes of its values and texture
+ * references (<property name, value> pairs), and of the names of its references to nodes and graphs (referenced ids
+ * are not hashed, since ancestor and version ids are not matched yet).
+ */
+static std::vector<size_t> node_features(const node& node)
+{
+	std::vector<size_t> features;
+	features.reserve(node.node_values.size() + node.texture_references.size() + node.graph_references.size() +
+					 node.node_references.size() + node.input_references.size());
+	for (const auto& [property_name, value] : node.node_values)
+	{
+		features.push_back(property_hash(property_name, value));
+	}
+	for (const auto& [property_name, texture_reference] : node.texture_references)
+	{
+		size_t texture_hash = 0;
+		for (const auto& [texture_property_name, value] : texture_reference)
+		{
+			texture_hash += property_hash(texture_property_name, value);
+		}
+		features.push_back(property_hash(property_name, texture_hash));
+	}
+	for (const auto& [property_name, graph_reference] : node.graph_references)
+	{
+		features.push_back(property_name.name_hash());
+	}
+	for (const auto& [property_name, node_reference] : node.node_references)
+	{
+		features.push_back(property_name.name_hash());
+	}
+	for (const auto& [socket_name, input_reference] : node.input_references)
+	{
+		features.push_back(property_hash(socket_name, input_reference.socket_name.name_hash()));
+	}
+	return features;
+}
+
+match_candidates<node_ref> minhash_candidates::operator()(const graph& ancestor, const graph& version) const
+{
+	// Seeds of the hash functions of the signature's rows
+	const size_t signature_size = bands * rows;
+	std::vector<uint64_t> seeds(signature_size);
+	for (size_t row = 0; row < signature_size; ++row)
+	{
+		seeds[row] = mix_hash(row + 1);
+	}
+
+	// Keys of the bands of a node's signature (the node type is hashed too, so that only nodes with the same type
+	// collide)
+	std::vector<uint64_t> signature(signature_size);
+	auto band_keys = [&](const node& node, std::vector<size_t>& keys) {
+		std::fill(signature.begin(), signature.end(), std::numeric_limits<uint64_t>::max());
+		for (size_t feature : node_features(node))
+		{
+			for (size_t row = 0; row < signature_size; ++row)
+			{
+				signature[row] = std::min(signature[row], mix_hash(feature ^ seeds[row]));
+			}
+		}
+		const std::string& node_type = get_node_type(node);
+		keys.resize(bands);
+		for (size_t band = 0; band < bands; ++band)
+		{
+			keys[band] = 0;
+			hash_combine(keys[band], node_type, band);
+			for (size_t row = band * rows; row < (band + 1) * rows; ++row)
+			{
+				hash_combine(keys[band], signature[row]);
+			}
+		}
+	};
+
+	// Ancestor nodes grouped by band key
+	std::unordered_map<size_t, std::vector<node_ref>> ancestor_bands;
+	std::vector<size_t> keys;
+	for (const auto& [node_id, node] : ancestor.nodes)
+	{
+		band_keys(node, keys);
+		for (size_t key : keys)
+		{
+			ancestor_bands[key].push_back(node_id);
+		}
+	}
+
+	// Candidates of a version node are the ancestor nodes colliding with it in some band
+	match_candidates<node_ref> candidates;
+	std::vector<node_ref> node_candidates;
+	for (const auto& [node_id, node] : version.nodes)
+	{
+		band_keys(node, keys);
+		node_candidates.clear();
+		for (size_t key : keys)
+		{
+			auto band = ancestor_bands.find(key);
+			if (band == ancestor_bands.end()) { continue; }
+			node_candidates.insert(node_candidates.end(), band->second.begin(), band->second.end());
+		}
+		if (node_candidates.empty()) { continue; }
+		std::sort(node_candidates.begin(), node_candidates.end());
+		node_candidates.erase(std::unique(node_candidates.begin(), node_candidates.end()), node_candidates.end());
+		candidates.emplace(node_id, node_candidates);
+	}
+	return candidates;
+}
+
+/*
+ * Hierarchical matching of nodes by region (see nd::node_region_fn): container nodes are matched first, then the nodes
+ * of each pair of matched containers are matched among themselves, in parallel when ND_PARALLELIZE is defined.
+ * Note: each pair of regions is matched knowing only the matches found before matching regions, hence the matches
+ * do not depend on the order in which regions are matched.
+ *
+ * Function parameters:
+ *	- ancestor: ancestor graph
+ *	- version: version graph
+ *	- ancestor_objects: objects matched in place of the ancestor nodes (e.g. the nodes themselves), by node id
+ *	- version_objects: objects matched in place of the version nodes (e.g. the nodes themselves), by node id
+ *	- region_fn: function returning the container node of a node's region
+ *	- passes: passes used for matching containers and regions (their edit cost function takes objects)
+ *	- bucket_fn: function returning the bucket key of an object (see nd::match_objects)
+ *	- dependents: map from a version node id to the ids of the version nodes referring to it
+ *	- initial_match: matches known before matching regions (e.g. prematched nodes)
+ *	- budget: budget of the matching (see nd::match_budget), nullptr if there's no budget
+ *	- call_statistics: statistics of the calling matching function (see nd::match_objects)
+ *
+ * Returns: bidirectional map containing the initial matches plus the nodes matched by region.
+ */
+template <typename ObjectMap, typename CostFn>
+static ref_match<node_ref> match_node_regions(const graph& ancestor, const graph& version,
+											  const ObjectMap& ancestor_objects, const ObjectMap& version_objects,
+											  const node_region_fn& region_fn,
+											  const std::vector<basic_match_pass<node_ref, CostFn>>& passes,
+											  const nd::bucket_fn<typename ObjectMap::mapped_type>& bucket_fn,
+											  const std::unordered_map<node_ref, std::vector<node_ref>>& dependents,
+											  ref_match<node_ref> initial_match, const match_budget* budget,
+											  match_call_statistics* call_statistics)
+{
+	using ObjectType = typename ObjectMap::mapped_type;
+	// Regions are collections of <id, object pointer> pairs, so that objects are not copied
+	using node_map = std::unordered_map<node_ref, const ObjectType*>;
+
+	// Passes evaluating the edit cost function on object pointers
+	auto pointer_cost_fn = [](const CostFn& cost_fn) {
+		return [&cost_fn](const ObjectType* ancestor_object, const ObjectType* version_object,
+						  const ref_match<node_ref>& node_matches, float bound = nd::float_inf) -> float {
+			if constexpr (std::is_invocable_r_v<float, const CostFn&, const ObjectType&, const ObjectType&,
+												const ref_match<node_ref>&, float>)
+			{
+				return cost_fn(*ancestor_object, *version_object, node_matches, bound);
+			}
+			else
+			{
+				return cost_fn(*ancestor_object, *version_object, node_matches);
+			}
+		};
+	};
+	std::vector<basic_match_pass<node_ref, decltype(pointer_cost_fn(passes.front().cost_fn))>> region_passes;
+	region_passes.reserve(passes.size());
+	for (const auto& pass : passes)
+	{
+		region_passes.push_back({.cost_fn	 = pointer_cost_fn(pass.cost_fn),
+								 .threshold	 = pass.threshold,
+								 .engine	 = pass.engine,
+								 .keys		 = pass.keys,
+								 .neighbours = pass.neighbours,
+								 .candidates = pass.candidates,
+								 .beam_width = pass.beam_width});
+	}
+	auto pointer_bucket_fn = [&bucket_fn](const ObjectType* object) -> std::string { return bucket_fn(*object); };
+
+	// Group nodes by region, and collect the container nodes
+	auto group_regions = [&](const graph& graph, const ObjectMap& objects, node_map& containers,
+							 std::unordered_map<node_ref, node_map>& regions) {
+		for (const auto& [node_id, node] : graph.nodes)
+		{
+			const node_ref container_id = region_fn(node);
+			if (container_id == node_ref::invalid_ref || !graph.nodes.contains(container_id)) { continue; }
+			regions[container_id].emplace(node_id, &objects.at(node_id));
+			containers.emplace(container_id, &objects.at(container_id));
+		}
+	};
+	node_map ancestor_containers, version_containers;
+	std::unordered_map<node_ref, node_map> ancestor_regions, version_regions;
+	group_regions(ancestor, ancestor_objects, ancestor_containers, ancestor_regions);
+	group_regions(version, version_objects, version_containers, version_regions);
+
+	// Match containers
+	ref_match<node_ref> match = match_objects<node_ref>(ancestor_containers, version_containers, region_passes,
+														&dependents, pointer_bucket_fn, std::move(initial_match),
+														budget, call_statistics);
+
+	// Pairs of regions whose containers got matched (sorted, so that statistics do not depend on regions order)
+	struct region_pair
+	{
+		node_ref ancestor_container;
+		const node_map* ancestor_region;
+		const node_map* version_region;
+		ref_match<node_ref> match = {};
+	};
+	std::vector<region_pair> region_pairs;
+	for (const auto& [ancestor_container_id, ancestor_region] : ancestor_regions)
+	{
+		if (!match.has_match_in_version(ancestor_container_id)) { continue; }
+		auto version_region = version_regions.find(match.to_version(ancestor_container_id));
+		if (version_region == version_regions.end()) { continue; }
+		region_pairs.push_back({.ancestor_container = ancestor_container_id,
+								.ancestor_region	= &ancestor_region,
+								.version_region		= &version_region->second});
+	}
+	std::sort(region_pairs.begin(), region_pairs.end(), [](const region_pair& a, const region_pair& b) {
+		return a.ancestor_container < b.ancestor_container;
+	});
+
+	// Match nodes of each pair of regions
+	auto match_region_pair = [&](region_pair& pair) {
+		pair.match = match_objects<node_ref>(*pair.ancestor_region, *pair.version_region, region_passes, &dependents,
+											 pointer_bucket_fn, match, budget, call_statistics);
+	};
+#if defined(ND_PARALLELIZE)
+	std::for_each(std::execution::par, region_pairs.begin(), region_pairs.end(), match_region_pair);
+#else
+	std::for_each(region_pairs.begin(), region_pairs.end(), match_region_pair);
+#endif
+
+	// Merge the matches of the regions (regions are disjoint)
+	for (const region_pair& pair : region_pairs)
+	{
+		for (const auto& [version_node_id, version_node] : *pair.version_region)
+		{
+			if (!match.has_match_in_ancestor(version_node_id) && pair.match.has_match_in_ancestor(version_node_id))
+			{
+				match.add_match(pair.match.to_ancestor(version_node_id), version_node_id);
+			}
+		}
+		if (pair.match.is_degraded()) { match.set_degraded(); }
+	}
+	return match;
 }
 
 /*
@@ -318,18 +2342,120 @@ ref_match<graph_ref> match_graphs(const script& ancestor, const script& version)
  *	- ancestor: ancestor graph
  *	- version: version graph
  *	- graph_matches: bidirectional map of already matched graphs
+ *	- options: options of the matching (see nd::node_match_options)
+ *	- budget: budget of the matching (see nd::match_budget), nullptr if there's no budget
  *
  * Returns: bidirectional map containing matched graphs ids.
  */
-ref_match<node_ref> match_nodes(const graph& ancestor, const graph& version, const ref_match<graph_ref>& graph_matches)
+ref_match<node_ref> match_nodes(const graph& ancestor, const graph& version, const ref_match<graph_ref>& graph_matches,
+								const node_match_options& options, const match_budget* budget)
 {
+#ifdef ND_STATISTICS_ENABLED
+	nd::timer timer;
+	match_call_statistics call_statistics;
+	match_call_statistics* const call_statistics_ptr = &call_statistics;
+#else
+	match_call_statistics* const call_statistics_ptr = nullptr;
+#endif
 	// Create node edit cost function
 	auto cost_fn = [&](const node_ref& ancestor_node_id, const node_ref& version_node_id,
 					   const ref_match<node_ref>& node_matches) -> float {
 		return edit_cost(get_node(ancestor, ancestor_node_id), get_node(version, version_node_id), graph_matches,
 						 node_matches);
 	};
-	// Call matching algorithm (single-pass)
-	return match_objects<node_ref>(ancestor.nodes, version.nodes, cost_fn, 0.35f);
+	// Node edit cost depends on the matches of the nodes referenced by the version node (see nd::diff_node_references
+	// and nd::diff_input_references), so a version node depends on the version nodes it refers to
+	std::unordered_map<node_ref, std::vector<node_ref>> dependents = {};
+	for (const auto& [version_node_id, version_node] : version.nodes)
+	{
+		for (const auto& [property_name, node_reference] : version_node.node_references)
+		{
+			if (node_reference != node_ref::invalid_ref) { dependents[node_reference].push_back(version_node_id); }
+		}
+		for (const auto& [socket_name, input_reference] : version_node.input_references)
+		{
+			if (input_reference.node != node_ref::invalid_ref)
+			{
+				dependents[input_reference.node].push_back(version_node_id);
+			}
+		}
+	}
+	// Nodes with identical content are prematched, only the remaining ones are matched by the matching algorithm
+	ref_match<node_ref> prematch = prematch_nodes(ancestor, version, graph_matches, dependents, cost_fn);
+	// Nodes with different types have infinite edit cost, so only nodes with the same type are compared
+	const nd::bucket_fn<node> bucket_fn = [](const node& node) -> std::string { return get_node_type(node); };
+	// Node edit cost kernel used by the matching algorithm, it is evaluated on nodes already looked up, either nodes or
+	// rows of the columnar graphs (bounded, so that the matching algorithm can stop evaluating edit costs exceeding the
+	// best ones found so far)
+	auto cost_kernel = [&](const auto& ancestor_node, const auto& version_node, const ref_match<node_ref>& node_matches,
+						   float bound = nd::float_inf) -> float {
+		return edit_cost(ancestor_node, version_node, graph_matches, node_matches, bound);
+	};
+	std::vector<basic_match_pass<node_ref, decltype(cost_kernel)>> passes;
+	// Nodes with the same unique structural hash are anchored first (optional pass)
+	match_keys<node_ref> structural_keys;
+	if (options.structural_anchoring)
+	{
+		constexpr size_t structural_hash_rounds = 3;
+		structural_keys = {.ancestor = structural_hashes(ancestor, structural_hash_rounds),
+						   .version	 = structural_hashes(version, structural_hash_rounds)};
+		passes.push_back(
+			{.cost_fn = cost_kernel, .threshold = 0.35f, .engine = match_engine::anchor, .keys = &structural_keys});
+	}
+	// Matches are propagated from the nodes matched so far through input references (optional pass)
+	match_neighbours<node_ref> input_neighbours;
+	if (options.similarity_propagation)
+	{
+		input_neighbours = {.ancestor = input_reference_neighbours(ancestor),
+							.version  = input_reference_neighbours(version)};
+		passes.push_back({.cost_fn	  = cost_kernel,
+						  .threshold  = 0.35f,
+						  .engine	  = match_engine::propagation,
+						  .neighbours = &input_neighbours});
+	}
+	// Version nodes are compared only with their candidate ancestor nodes first (optional pass)
+	match_candidates<node_ref> candidates;
+	if (options.candidates_fn)
+	{
+		candidates = options.candidates_fn(ancestor, version);
+		passes.push_back({.cost_fn	  = cost_kernel,
+						  .threshold  = 0.35f,
+						  .engine	  = options.engine,
+						  .candidates = &candidates,
+						  .beam_width = options.beam_width});
+	}
+	passes.push_back(
+		{.cost_fn = cost_kernel, .threshold = 0.35f, .engine = options.engine, .beam_width = options.beam_width});
+	// Nodes are matched by region first (optional), then the remaining ones are matched globally; the objects matched
+	// are either the nodes or their rows in the columnar graphs (optional, their node types share the same schemas)
+	auto match_node_objects = [&](const auto& ancestor_objects, const auto& version_objects,
+								  const auto& object_bucket_fn) {
+		if (options.region_fn)
+		{
+			prematch = match_node_regions(ancestor, version, ancestor_objects, version_objects, options.region_fn,
+										  passes, object_bucket_fn, dependents, std::move(prematch), budget,
+										  call_statistics_ptr);
+		}
+		// Call matching algorithm
+		return match_objects<node_ref>(ancestor_objects, version_objects, passes, &dependents, object_bucket_fn,
+									   std::move(prematch), budget, call_statistics_ptr);
+	};
+	ref_match<node_ref> match;
+	if (options.columnar)
+	{
+		const node_schemas schemas			  = make_node_schemas(ancestor, version);
+		const columnar_graph ancestor_columns = make_columnar_graph(ancestor, schemas);
+		const columnar_graph version_columns  = make_columnar_graph(version, schemas);
+		const nd::bucket_fn<columnar_node> columnar_bucket_fn = [](const columnar_node& node) -> std::string {
+			return node.schema->type;
+		};
+		match = match_node_objects(ancestor_columns.nodes, version_columns.nodes, columnar_bucket_fn);
+	}
+	else { match = match_node_objects(ancestor.nodes, version.nodes, bucket_fn); }
+#ifdef ND_STATISTICS_ENABLED
+	timer.stop();
+	call_statistics.collect("match_nodes", ancestor.nodes.size(), version.nodes.size(), timer.milliseconds());
+#endif
+	return match;
 }
 }; // namespace nd
\ No newline at end of file
@@ -1,10 +1,14 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 // Forward declarations
 namespace nd
 {
+struct columnar_node;
 struct graph_ref;
 struct node_ref;
 struct script;
@@ -59,9 +63,58 @@ class ref_match
 		return m_ancestor_to_version.contains(ancestor);
 	}
 
+	// Matches as a map from ancestor references to the matched version references
+	[[nodiscard]] inline const std::unordered_map<RefType, RefType>& ancestor_to_version() const
+	{
+		return m_ancestor_to_version;
+	}
+
+	// Mark matches as degraded, i.e. the matching algorithm ran out of budget before matching all the references
+	inline void set_degraded() { m_is_degraded = true; }
+	// Returns true if the matching algorithm ran out of budget (see nd::match_budget); references it did not get to
+	// match are left without a match
+	[[nodiscard]] inline bool is_degraded() const { return m_is_degraded; }
+
   private:
 	std::unordered_map<RefType, RefType> m_ancestor_to_version;
 	std::unordered_map<RefType, RefType> m_version_to_ancestor;
+	bool m_is_degraded = false;
+};
+
+/*
+ * Node matches of the matched graph pairs of two scripts, keyed by ancestor graph.
+ */
+using graph_node_matches = std::unordered_map<graph_ref, ref_match<node_ref>>;
+
+/*
+ * Time budget and cancellation token of a matching. The matching algorithm checks the budget at each step: once it is
+ * expired (i.e. its deadline has passed or its cancellation has been requested), the matches found so far are kept
+ * while the objects still to match are left without a match (i.e. they'll be diffed as added/deleted), and the matches
+ * are marked as degraded.
+ * Note: the same budget can be shared by many matchings (e.g. all the matchings of a diff).
+ */
+class match_budget
+{
+  public:
+	// Budget without deadline (it expires only if cancelled)
+	match_budget() = default;
+	// Budget whose deadline is the given time from now
+	explicit match_budget(std::chrono::milliseconds time_budget)
+		: m_deadline(std::chrono::steady_clock::now() + time_budget)
+	{
+	}
+
+	// Request the cancellation of the matching (it can be called by any thread)
+	inline void cancel() { m_is_cancelled.store(true, std::memory_order_relaxed); }
+	// Returns true if the deadline has passed or the cancellation has been requested
+	[[nodiscard]] inline bool is_expired() const
+	{
+		return m_is_cancelled.load(std::memory_order_relaxed) || std::chrono::steady_clock::now() >= m_deadline;
+	}
+
+  private:
+	std::chrono::steady_clock::time_point m_deadline = std::chrono::steady_clock::time_point::max();
+	std::atomic<bool> m_is_cancelled				 = false;
 };
 
 /*
@@ -72,18 +125,173 @@ template <typename RefType>
 using cost_fn = std::function<float(const RefType&, const RefType&, const ref_match<RefType>&)>;
 
 /*
- * A match pass is modeled as a structure containing two objects:
+ * Engines available for finding the matches of a pass. Greedy engines find the same matches, they differ only in how
+ * the minimum edit cost candidate match is searched at each greedy step:
+ *	- scan: all the pairs of objects still to match are scanned at each step (edit costs are cached when possible)
+ *	- heap: the best candidate match of each object is kept in a min-heap ordered by edit cost, and only the
+ *			candidates of objects whose edit cost could have changed after a new match are searched again. It requires
+ *			the dependents of the objects to be known, otherwise the scan engine is used.
+ * The optimal engine instead finds the matches by solving the assignment problem (i.e. minimizing the total edit cost
+ * of the matches) between the objects to match, instead of greedily:
+ *	- optimal: the assignment problem is solved with the edit costs known before the new matches, hence it is solved
+ *			   again as long as new matches change the edit costs and new pairs below threshold are found.
+ * The anchor engine only matches objects identified by a key (e.g. a structural hash), without searching candidates:
+ *	- anchor: an ancestor and a version object are matched if they have the same key, their key is unique among both
+ *			  the ancestor and the version objects to match, and their edit cost (evaluated knowing all such pairs) is
+ *			  below threshold. It requires the keys of the objects (see nd::match_keys), otherwise no match is found.
+ * The propagation engine only searches candidates among the neighbours of already matched objects:
+ *	- propagation: starting from the pairs matched so far, the neighbours still to match of the ancestor object and of
+ *				   the version object of a pair are matched greedily among themselves (below threshold), and new pairs
+ *				   are propagated in turn. Objects that can't be reached are left to the next passes. It requires the
+ *				   neighbours of the objects (see nd::match_neighbours), otherwise no match is found.
+ * The beam engine searches many greedy matchings at once:
+ *	- beam: at each step, each of the best beam_width partial matchings found so far is extended with each of its
+ *			beam_width minimum edit cost candidate matches, and the best beam_width extended partial matchings (i.e.
+ *			with minimum sum of edit costs plus number of objects left to match) are kept; partial matchings are
+ *			extended in parallel. A beam of width 1 finds the same matches of the greedy engines, while wider beams
+ *			can find better matches than greedy ones. Note: edit costs are not cached, since each partial matching
+ *			has its own matches.
+ */
+enum class match_engine
+{
+	scan,
+	heap,
+	optimal,
+	anchor,
+	propagation,
+	beam
+};
+
+/*
+ * Keys of ancestor and version objects used by the anchor engine (see nd::match_engine). Objects without a key are
+ * never matched by the anchor engine.
+ */
+template <typename RefType>
+struct match_keys
+{
+	std::unordered_map<RefType, size_t> ancestor = {};
+	std::unordered_map<RefType, size_t> version	 = {};
+};
+
+/*
+ * Neighbours of ancestor and version objects used by the propagation engine (see nd::match_engine). Objects without
+ * neighbours are never matched by the propagation engine.
+ */
+template <typename RefType>
+struct match_neighbours
+{
+	std::unordered_map<RefType, std::vector<RefType>> ancestor = {};
+	std::unordered_map<RefType, std::vector<RefType>> version  = {};
+};
+
+/*
+ * Map from a version object to its candidate ancestor objects, used by the scan and heap engines (see
+ * nd::match_engine) for pruning the pairs of objects evaluated: a version object in the map is only compared with its
+ * candidate ancestor objects, while a version object not in the map is compared with all the ancestor objects.
+ */
+template <typename RefType>
+using match_candidates = std::unordered_map<RefType, std::vector<RefType>>;
+
+/*
+ * A match pass is modeled as a structure containing seven objects:
  * 1- The edit cost function to use in a given pass
  * 2- The threshold value to use in a given pass
+ * 3- The engine used for finding the matches in a given pass
+ * 4- The keys of the objects, used only by the anchor engine (nullptr if not needed)
+ * 5- The neighbours of the objects, used only by the propagation engine (nullptr if not needed)
+ * 6- The candidate ancestor objects of version objects, used by the scan and heap engines (nullptr if all the pairs of
+ *	  objects must be evaluated)
+ * 7- The number of partial matchings kept by the beam engine (used only by the beam engine)
  *
  * Passes are used by the matching algorithm to allow cascading use of multiple matching's heuristics.
+ * The edit cost function can be any callable CostFn (so that the matching algorithm can inline it) taking either two
+ * references, or the two referenced objects (e.g. two nd::node), and a bidirectional map of matches. If it takes the
+ * objects, it can also take an upper bound as last parameter (branch and bound): the matching algorithm passes the
+ * best edit cost found so far (or the threshold), and edit costs exceeding it can be returned as any lower bound
+ * greater than it (see the bounded nd::edit_cost).
  */
-template <typename RefType>
-struct match_pass
+template <typename RefType, typename CostFn>
+struct basic_match_pass
 {
-	nd::cost_fn<RefType> cost_fn;
+	CostFn cost_fn;
 	float threshold;
+	nd::match_engine engine							= nd::match_engine::scan;
+	const nd::match_keys<RefType>* keys				= nullptr;
+	const nd::match_neighbours<RefType>* neighbours = nullptr;
+	const nd::match_candidates<RefType>* candidates = nullptr;
+	size_t beam_width								= 1;
 };
+
+/*
+ * Candidate pruning function: given an ancestor and a version graph, it returns the candidate ancestor nodes of the
+ * version nodes (see nd::match_candidates).
+ */
+using node_candidates_fn = std::function<match_candidates<node_ref>(const graph& ancestor, const graph& version)>;
+
+/*
+ * Candidate pruning function (see nd::node_candidates_fn) based on MinHash locality-sensitive hashing: each node is
+ * described by the set of its features (i.e. hashes of its <property name, value> pairs and of its references' names),
+ * and its MinHash signature (bands * rows minimum hashes of its features) is split in bands of rows hashes. A version
+ * node is compared only with the ancestor nodes of its type colliding with it in at least one band, namely sharing all
+ * the rows of that band. Version nodes colliding with no ancestor node are compared with all the ancestor nodes.
+ * Two nodes whose feature sets have Jaccard similarity s collide with probability 1 - (1 - s^rows)^bands: more bands
+ * increase recall (i.e. similar nodes are more likely to be compared), while more rows increase pruning (i.e.
+ * dissimilar nodes are less likely to be compared).
+ */
+struct minhash_candidates
+{
+	size_t bands = 32;
+	size_t rows	 = 8;
+
+	match_candidates<node_ref> operator()(const graph& ancestor, const graph& version) const;
+};
+
+/*
+ * Region function: given a node, it returns the container node of the region it belongs to (e.g. the frame enclosing
+ * it), or nd::node_ref::invalid_ref if it doesn't belong to any region.
+ */
+using node_region_fn = std::function<node_ref(const node& node)>;
+
+/*
+ * Options of the node matching algorithm (see nd::match_nodes):
+ *	- engine: engine used for finding the matches (see nd::match_engine)
+ *	- beam_width: number of partial matchings kept by the beam engine (used only if engine is nd::match_engine::beam)
+ *	- structural_anchoring: if true, nodes are anchored (i.e. matched by the anchor engine) before finding the
+ *							matches with the engine, using Weisfeiler-Lehman style structural hashes as keys: the
+ *							hash of each node's type, iteratively combined with the hashes of the nodes it refers to
+ *							and of the nodes referring to it. So nodes whose values changed, but whose neighbourhood
+ *							did not, are matched without searching candidates.
+ *	- similarity_propagation: if true, before finding the matches with the engine, matches are propagated from the
+ *							  nodes matched so far (i.e. by the propagation engine) through input references, so
+ *							  that the engine only searches the matches of the nodes that can't be reached.
+ *	- candidates_fn: candidate pruning plugin. If it is set, it's called with the ancestor and version graphs, then
+ *					 nodes are matched by the engine comparing each version node only with its candidate ancestor
+ *					 nodes (see nd::match_candidates) before comparing the remaining nodes with each other.
+ *	- region_fn: if it is set, nodes are matched hierarchically by region (see nd::node_region_fn): container nodes
+ *				 are matched first, then the nodes of each pair of matched containers are matched among themselves
+ *				 (pairs are matched in parallel), and finally the remaining nodes (i.e. nodes without a region, or
+ *				 whose container did not get matched) are matched globally. So one big matching problem is split into
+ *				 many small ones, but nodes moved to a different region can only be matched by the global pass.
+ *	- columnar: if true, edit costs are evaluated on a columnar representation of the graphs (see
+ *				nd::columnar_graph), built before matching: the properties of the nodes of a type are stored in dense
+ *				index-aligned rows, instead of being looked up by name. The matches found are the same.
+ */
+struct node_match_options
+{
+	nd::match_engine engine			 = nd::match_engine::heap;
+	size_t beam_width				 = 1;
+	bool structural_anchoring		 = false;
+	bool similarity_propagation		 = false;
+	node_candidates_fn candidates_fn = nullptr;
+	node_region_fn region_fn		 = nullptr;
+	bool columnar					 = false;
+};
+
+/*
+ * Match pass whose edit cost function is a nd::cost_fn (see nd::basic_match_pass).
+ */
+template <typename RefType>
+using match_pass = basic_match_pass<RefType, nd::cost_fn<RefType>>;
 }; // namespace nd
 
 ///
@@ -107,6 +315,28 @@ namespace nd
  */
 [[nodiscard]] float edit_cost(const node& ancestor, const node& version, const ref_match<graph_ref>& graph_matches,
 							  const ref_match<node_ref>& node_matches);
+/*
+ * Bounded node edit cost function: same as the node edit cost function above, but properties are compared only until
+ * the edit cost is known to exceed the bound, so that clearly bad pairs of nodes are discarded early.
+ *
+ * Function parameters:
+ *	- ancestor: ancestor node
+ *	- version: version node
+ *	- graph_matches: bidirectional map of graph matches calculated so far
+ *	- node_matches: bidirectional map of node matches calculated so far
+ *	- bound: upper bound of the edit costs of interest (e.g. the best edit cost found so far)
+ *
+ * Returns: the edit cost if it does not exceed the bound, otherwise a lower bound of the edit cost exceeding the bound.
+ */
+[[nodiscard]] float edit_cost(const node& ancestor, const node& version, const ref_match<graph_ref>& graph_matches,
+							  const ref_match<node_ref>& node_matches, float bound);
+/*
+ * Bounded node edit cost function on the rows of a columnar graph (see nd::columnar_graph): same as the bounded node
+ * edit cost function above, but properties are compared by looping over the index-aligned columns of the rows.
+ */
+[[nodiscard]] float edit_cost(const columnar_node& ancestor, const columnar_node& version,
+							  const ref_match<graph_ref>& graph_matches, const ref_match<node_ref>& node_matches,
+							  float bound);
 /*
  * Graph edit cost function described in NodeGit's paper work.
  * Note: this function is used by the matching algorithm for obtaining a nd::ref_match<graph_ref> object, namely
@@ -122,14 +352,20 @@ namespace nd
 [[nodiscard]] float edit_cost(const graph& ancestor, const graph& version);
 
 /*
- * Matches ancestor and version scripts' graphs using the matching algorithm.
- * It returns the bidirectional map containing all the matched graphs.
+ * Matches ancestor and version scripts' graphs using the matching algorithm (the engine can be specified, see
+ * nd::match_engine, as well as a budget, see nd::match_budget). It returns the bidirectional map containing all the
+ * matched graphs.
  */
-[[nodiscard]] ref_match<graph_ref> match_graphs(const script& ancestor, const script& version);
+[[nodiscard]] ref_match<graph_ref> match_graphs(const script& ancestor, const script& version,
+												match_engine engine = match_engine::scan,
+												const match_budget* budget = nullptr);
 /*
- * Matches ancestor and version graphs' nodes using the matching algorithm.
- * It returns the bidirectional map containing all the matched nodes.
+ * Matches ancestor and version graphs' nodes using the matching algorithm (its options can be specified, see
+ * nd::node_match_options, as well as a budget, see nd::match_budget). It returns the bidirectional map containing all
+ * the matched nodes.
  */
 [[nodiscard]] ref_match<node_ref> match_nodes(const graph& ancestor, const graph& version,
-											  const ref_match<graph_ref>& graph_matches);
+											  const ref_match<graph_ref>& graph_matches,
+											  const node_match_options& options = {},
+											  const match_budget* budget = nullptr);
 }; // namespace nd
\ No newline at end of file
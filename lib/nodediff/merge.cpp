@@ -3,6 +3,8 @@
 #include "diff.h"
 #include "utility/utility.h"
 
+#include <algorithm>
+
 namespace nd
 {
 bool check_diff_conflicts(const graph_diff& diff1, const graph_diff& diff2,
@@ -35,7 +37,7 @@ bool check_diff_conflicts(const graph_diff& diff1, const graph_diff& diff2,
 						node_change2.diff.node_values.at(property_name) != value)
 					{
 						// Merge conflict
-						conflicting_properties.emplace_back(property_name);
+						conflicting_properties.emplace_back(property_name.name());
 					}
 				}
 
@@ -46,7 +48,7 @@ bool check_diff_conflicts(const graph_diff& diff1, const graph_diff& diff2,
 						node_change2.diff.node_references.at(property_name) != node_reference)
 					{
 						// Merge conflict
-						conflicting_properties.emplace_back(property_name);
+						conflicting_properties.emplace_back(property_name.name());
 					}
 				}
 
@@ -57,7 +59,7 @@ bool check_diff_conflicts(const graph_diff& diff1, const graph_diff& diff2,
 						node_change2.diff.graph_references.at(property_name) != graph_reference)
 					{
 						// Merge conflict
-						conflicting_properties.emplace_back(property_name);
+						conflicting_properties.emplace_back(property_name.name());
 					}
 				}
 
@@ -68,7 +70,7 @@ bool check_diff_conflicts(const graph_diff& diff1, const graph_diff& diff2,
 						node_change2.diff.texture_references.at(property_name) != texture_reference)
 					{
 						// Merge conflict
-						conflicting_properties.emplace_back(property_name);
+						conflicting_properties.emplace_back(property_name.name());
 					}
 				}
 
@@ -79,11 +81,14 @@ bool check_diff_conflicts(const graph_diff& diff1, const graph_diff& diff2,
 						node_change2.diff.input_references.at(socket_name) != input_references)
 					{
 						// Merge conflict
-						conflicting_edges.emplace_back(socket_name);
+						conflicting_edges.emplace_back(socket_name.name());
 					}
 				}
 				if (!conflicting_properties.empty() || !conflicting_edges.empty())
 				{
+					// Sorted, so that conflicts do not depend on properties order
+					std::sort(conflicting_properties.begin(), conflicting_properties.end());
+					std::sort(conflicting_edges.begin(), conflicting_edges.end());
 					conflicts.emplace_back(node_conflict{.type_v	 = node_conflict::type::edit_edit,
 														 .node		 = node_id1,
 														 .properties = conflicting_properties,
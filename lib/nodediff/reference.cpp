@@ -1,19 +1,127 @@
 #include "reference.h"
 
+#include "symbol.h"
+#include "utility/macro.h"
+#include "utility/uuid.h"
+
 ///
-/// STL
+/// Reference ids
 ///
-namespace std
+namespace nd
+{
+// Length of a formatted uuid, e.g. "0065e7d7-418c-4da4-b4d6-b54b6cf7466a"
+static constexpr size_t uuid_length = 36;
+
+// Returns true if a dash is expected at the given position of a formatted uuid
+static constexpr bool is_uuid_dash(size_t position)
 {
-size_t hash<nd::node_ref>::operator()(const nd::node_ref& node_reference) const
+	return position == 8 || position == 13 || position == 18 || position == 23;
+}
+
+// Value of a lowercase hex digit, or -1 if the character is not one
+static int hex_digit(char character)
 {
-	return hash<std::string>()(node_reference.name);
+	if (character >= '0' && character <= '9') { return character - '0'; }
+	if (character >= 'a' && character <= 'f') { return character - 'a' + 10; }
+	return -1;
 }
-size_t hash<nd::graph_ref>::operator()(const nd::graph_ref& graph_reference) const
+
+/*
+ * Parses a formatted uuid (lowercase, as formatted by nd::uuid) into its high and low 64 bits.
+ *
+ * Returns: false if the name is not a formatted RFC 4122 uuid (e.g. uppercase, or another variant), so that only names
+ *			which are formatted back to themselves are parsed.
+ */
+static bool parse_uuid(std::string_view name, out_var uint64_t& high, out_var uint64_t& low)
 {
-	return hash<std::string>()(graph_reference.name);
+	if (name.size() != uuid_length) { return false; }
+	uint64_t halves[2] = {0, 0};
+	size_t digits	   = 0;
+	for (size_t position = 0; position < uuid_length; ++position)
+	{
+		if (is_uuid_dash(position))
+		{
+			if (name[position] != '-') { return false; }
+			continue;
+		}
+		const int digit = hex_digit(name[position]);
+		if (digit < 0) { return false; }
+		uint64_t& half = halves[digits++ / 16];
+		half		   = (half << 4) | static_cast<uint64_t>(digit);
+	}
+	high = halves[0];
+	low	 = halves[1];
+	return (low >> 62) == 0b10;
 }
 
+// Formats the high and low 64 bits of a uuid (the buffer must hold at least uuid_length characters)
+static void format_uuid(uint64_t high, uint64_t low, char* buffer)
+{
+	constexpr char hex_digits[] = "0123456789abcdef";
+	const uint64_t halves[2]	= {high, low};
+	size_t digits				= 0;
+	for (size_t position = 0; position < uuid_length; ++position)
+	{
+		if (is_uuid_dash(position))
+		{
+			buffer[position] = '-';
+			continue;
+		}
+		const uint64_t half = halves[digits / 16];
+		buffer[position]	= hex_digits[(half >> (4 * (15 - digits % 16))) & 0xf];
+		++digits;
+	}
+}
+
+ref_id::ref_id(std::string_view name)
+{
+	if (!parse_uuid(name, m_high, m_low))
+	{
+		m_high = 0;
+		m_low  = symbol(name).id();
+	}
+}
+ref_id::ref_id(const std::string& name) : ref_id(std::string_view(name)) {}
+ref_id::ref_id(const char* name) : ref_id(std::string_view(name)) {}
+ref_id::ref_id(const uuid& uuid)
+{
+	const unsigned char* bytes = uuid.data();
+	for (size_t index = 0; index < 8; ++index)
+	{
+		m_high = (m_high << 8) | bytes[index];
+		m_low  = (m_low << 8) | bytes[8 + index];
+	}
+}
+
+std::string ref_id::name() const
+{
+	if (!is_uuid()) { return symbol::from_id(static_cast<uint32_t>(m_low)).name(); }
+	std::string name(uuid_length, '\0');
+	format_uuid(m_high, m_low, name.data());
+	return name;
+}
+
+bool ref_id::operator<(const ref_id& other) const
+{
+	// Formatted uuids are ordered as their bits (lowercase hex digits and dashes at the same positions)
+	if (is_uuid() && other.is_uuid()) { return m_high != other.m_high ? m_high < other.m_high : m_low < other.m_low; }
+	if (*this == other) { return false; }
+	// Otherwise names are compared (uuids are formatted on the stack)
+	auto name_view = [](const ref_id& id, char* buffer) -> std::string_view {
+		if (!id.is_uuid()) { return symbol::from_id(static_cast<uint32_t>(id.m_low)).name(); }
+		format_uuid(id.m_high, id.m_low, buffer);
+		return {buffer, uuid_length};
+	};
+	char buffer[uuid_length], other_buffer[uuid_length];
+	return name_view(*this, buffer) < name_view(other, other_buffer);
+}
+}; // namespace nd
+
+///
+/// STL
+///
+namespace std
+{
 ostream& operator<<(ostream& os, const nd::node_ref& node_reference)
 {
 	os << nd::json(node_reference);
@@ -26,17 +134,6 @@ ostream& operator<<(ostream& os, const nd::graph_ref& graph_reference)
 }
 }; // namespace std
 
-/// 
-/// Operators
-/// 
-namespace nd
-{
-bool node_ref::operator==(const node_ref& other) const { return this->name == other.name; }
-bool node_ref::operator!=(const node_ref& other) const { return !(*this == other); }
-bool graph_ref::operator==(const graph_ref& other) const { return this->name == other.name; }
-bool graph_ref::operator!=(const graph_ref& other) const { return !(*this == other); }
-}; // namespace nd
-
 ///
 /// Serialization/Deserialization with nlohmann::json
 ///
@@ -44,9 +141,15 @@ namespace nlohmann
 {
 using namespace nd;
 
-void adl_serializer<node_ref>::to_json(nd::json& j, const node_ref& node_ref) { j = node_ref.name; }
-void adl_serializer<node_ref>::from_json(const nd::json& j, node_ref& node_ref) { node_ref.name = j; }
+void adl_serializer<node_ref>::to_json(nd::json& j, const node_ref& node_ref) { j = node_ref.name(); }
+void adl_serializer<node_ref>::from_json(const nd::json& j, node_ref& node_ref)
+{
+	node_ref.id = ref_id(j.get_ref<const std::string&>());
+}
 
-void adl_serializer<graph_ref>::to_json(nd::json& j, const nd::graph_ref& graph_ref) { j = graph_ref.name; }
-void adl_serializer<graph_ref>::from_json(const nd::json& j, nd::graph_ref& graph_ref) { graph_ref.name = j; }
-}; // namespace nlohmann
\ No newline at end of file
+void adl_serializer<graph_ref>::to_json(nd::json& j, const nd::graph_ref& graph_ref) { j = graph_ref.name(); }
+void adl_serializer<graph_ref>::from_json(const nd::json& j, nd::graph_ref& graph_ref)
+{
+	graph_ref.id = ref_id(j.get_ref<const std::string&>());
+}
+}; // namespace nlohmann
@@ -2,6 +2,9 @@
 #include "utility/types.h"
 #include "value.h"
 
+#include <cstdint>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 
 // Forward declarations
@@ -11,6 +14,7 @@ struct node_ref;
 struct graph_ref;
 
 struct value;
+class uuid;
 }; // namespace nd
 
 ///
@@ -37,7 +41,7 @@ struct hash<nd::graph_ref>
 };
 } // namespace std
 
-/// 
+///
 /// References
 ///
 namespace nd
@@ -52,38 +56,91 @@ struct texture_ref : std::unordered_map<std::string, value>
 };
 
 /*
-* A reference to a node is modeled as a string. 
+ * Identifier of a reference (see nd::node_ref and nd::graph_ref), stored in 128 bits so that ids are copied, compared
+ * and hashed in O(1). Names formatted as RFC 4122 uuids (e.g. "0065e7d7-418c-4da4-b4d6-b54b6cf7466a", see nd::uuid)
+ * are stored as the uuid's bytes, any other name (e.g. "nd_Main") is interned as a symbol (see nd::symbol) and stored
+ * as its id. Ids are converted back to names only when needed (e.g. when serialized).
+ *
+ * Note: ids are ordered as their names, so that sorting ids does not depend on how they're stored.
+ */
+class ref_id
+{
+  public:
+	// Empty name
+	ref_id() = default;
+	ref_id(std::string_view name);
+	ref_id(const std::string& name);
+	ref_id(const char* name);
+	explicit ref_id(const uuid& uuid);
+
+	// Returns true if the id stores a uuid, false if it stores an interned name
+	[[nodiscard]] bool is_uuid() const { return (m_low >> 62) == uuid_variant; }
+	// Name of the id (i.e. the formatted uuid, or the interned name)
+	[[nodiscard]] std::string name() const;
+	[[nodiscard]] size_t hash() const { return m_high ^ m_low; }
+
+	bool operator==(const ref_id& other) const { return m_high == other.m_high && m_low == other.m_low; }
+	bool operator!=(const ref_id& other) const { return !(*this == other); }
+	bool operator<(const ref_id& other) const;
+
+  private:
+	// RFC 4122 variant (the 2 most significant bits of the uuid's 9th byte), symbol ids never have these bits set
+	static constexpr uint64_t uuid_variant = 0b10;
+
+	// Uuid's bytes 0-7 (big-endian), 0 for interned names
+	uint64_t m_high = 0;
+	// Uuid's bytes 8-15 (big-endian), symbol id for interned names
+	uint64_t m_low = 0;
+};
+
+/*
+* A reference to a node is modeled as a reference id (see nd::ref_id).
 * This struct at the moment is just used for enforcing type-checking by the compiler.
 */
 struct node_ref
 {
-	std::string name;
+	ref_id id;
 	static const node_ref invalid_ref;
 
-	bool operator==(const node_ref& other) const;
-	bool operator!=(const node_ref& other) const;
+	[[nodiscard]] std::string name() const { return id.name(); }
+
+	bool operator==(const node_ref& other) const { return id == other.id; }
+	bool operator!=(const node_ref& other) const { return id != other.id; }
+	bool operator<(const node_ref& other) const { return id < other.id; }
 };
 
 /*
- * A reference to a graph is modeled as a string.
+ * A reference to a graph is modeled as a reference id (see nd::ref_id).
  * This struct at the moment is just used for enforcing type-checking by the compiler.
  */
 struct graph_ref
 {
-	std::string name;
+	ref_id id;
 	static const graph_ref invalid_ref;
 
-	bool operator==(const graph_ref& other) const;
-	bool operator!=(const graph_ref& other) const;
+	[[nodiscard]] std::string name() const { return id.name(); }
+
+	bool operator==(const graph_ref& other) const { return id == other.id; }
+	bool operator!=(const graph_ref& other) const { return id != other.id; }
+	bool operator<(const graph_ref& other) const { return id < other.id; }
 };
 
 }; // namespace nd
 
-/// 
+///
 /// STL
-/// 
+///
 namespace std
 {
+inline size_t hash<nd::node_ref>::operator()(const nd::node_ref& node_reference) const
+{
+	return node_reference.id.hash();
+}
+inline size_t hash<nd::graph_ref>::operator()(const nd::graph_ref& graph_reference) const
+{
+	return graph_reference.id.hash();
+}
+
 ostream& operator<<(ostream& os, const nd::node_ref& node_reference);
 ostream& operator<<(ostream& os, const nd::graph_ref& graph_reference);
 }; // namespace std
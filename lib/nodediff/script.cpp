@@ -7,8 +7,8 @@
 ///
 namespace nd
 {
-const node_ref node_ref::invalid_ref   = {.name = ""};
-const graph_ref graph_ref::invalid_ref = {.name = ""};
+const node_ref node_ref::invalid_ref   = {.id = ""};
+const graph_ref graph_ref::invalid_ref = {.id = ""};
 const edge edge::invalid_edge		   = {.node = node_ref::invalid_ref, .socket_name = ""};
 } // namespace nd
 
@@ -27,103 +27,103 @@ bool edge::operator!=(const edge& other) const { return !(*this == other); }
 ///
 namespace nd
 {
-value& get_property_value(node& node, const std::string& property_name) { return node.node_values.at(property_name); }
-const value& get_property_value(const node& node, const std::string& property_name)
+value& get_property_value(node& node, const symbol& property_name) { return node.node_values.at(property_name); }
+const value& get_property_value(const node& node, const symbol& property_name)
 {
 	return node.node_values.at(property_name);
 }
-node_ref& get_node_reference(node& node, const std::string& property_name)
+node_ref& get_node_reference(node& node, const symbol& property_name)
 {
 	return node.node_references.at(property_name);
 }
-const node_ref& get_node_reference(const node& node, const std::string& property_name)
+const node_ref& get_node_reference(const node& node, const symbol& property_name)
 {
 	return node.node_references.at(property_name);
 }
-graph_ref& get_graph_reference(node& node, const std::string& property_name)
+graph_ref& get_graph_reference(node& node, const symbol& property_name)
 {
 	return node.graph_references.at(property_name);
 }
-const graph_ref& get_graph_reference(const node& node, const std::string& property_name)
+const graph_ref& get_graph_reference(const node& node, const symbol& property_name)
 {
 	return node.graph_references.at(property_name);
 }
 
-texture_ref& get_texture_reference(node& node, const std::string& property_name)
+texture_ref& get_texture_reference(node& node, const symbol& property_name)
 {
 	return node.texture_references.at(property_name);
 }
-const texture_ref& get_texture_reference(const node& node, const std::string& property_name)
+const texture_ref& get_texture_reference(const node& node, const symbol& property_name)
 {
 	return node.texture_references.at(property_name);
 }
-edge& get_input_reference(node& node, const std::string& socket_name) { return node.input_references.at(socket_name); }
-const edge& get_input_reference(const node& node, const std::string& socket_name)
+edge& get_input_reference(node& node, const symbol& socket_name) { return node.input_references.at(socket_name); }
+const edge& get_input_reference(const node& node, const symbol& socket_name)
 {
 	return node.input_references.at(socket_name);
 }
-void add_property_value(node& node, const std::string& property_name, const value& value)
+void add_property_value(node& node, const symbol& property_name, const value& value)
 {
 	node.node_values[property_name] = value;
 }
-void add_node_reference(node& node, const std::string& property_name, const node_ref& reference)
+void add_node_reference(node& node, const symbol& property_name, const node_ref& reference)
 {
 	node.node_references[property_name] = reference;
 }
-void add_graph_reference(node& node, const std::string& property_name, const graph_ref& reference)
+void add_graph_reference(node& node, const symbol& property_name, const graph_ref& reference)
 {
 	node.graph_references[property_name] = reference;
 }
-void add_texture_reference(node& node, const std::string& property_name, const texture_ref& reference)
+void add_texture_reference(node& node, const symbol& property_name, const texture_ref& reference)
 {
 	node.texture_references[property_name] = reference;
 }
-void add_input_reference(node& node, const std::string& socket_name, const edge& reference)
+void add_input_reference(node& node, const symbol& socket_name, const edge& reference)
 {
 	node.input_references[socket_name] = reference;
 }
-void set_property_value(node& node, const std::string& property_name, const value& value)
+void set_property_value(node& node, const symbol& property_name, const value& value)
 {
 	node.node_values.at(property_name) = value;
 }
-void set_node_reference(node& node, const std::string& property_name, const node_ref& reference)
+void set_node_reference(node& node, const symbol& property_name, const node_ref& reference)
 {
 	node.node_references.at(property_name) = reference;
 }
-void set_graph_reference(node& node, const std::string& property_name, const graph_ref& reference)
+void set_graph_reference(node& node, const symbol& property_name, const graph_ref& reference)
 {
 	node.graph_references.at(property_name) = reference;
 }
-void set_texture_reference(node& node, const std::string& property_name, const texture_ref& reference)
+void set_texture_reference(node& node, const symbol& property_name, const texture_ref& reference)
 {
 	node.texture_references.at(property_name) = reference;
 }
-void set_input_reference(node& node, const std::string& socket_name, const edge& reference)
+void set_input_reference(node& node, const symbol& socket_name, const edge& reference)
 {
 	node.input_references.at(socket_name) = reference;
 }
-void remove_property_value(node& node, const std::string& property_name)
+void remove_property_value(node& node, const symbol& property_name)
 {
 	assert(node.node_values.contains(property_name) && "Trying to remove a property value which does not exist");
 	node.node_values.erase(property_name);
 }
-void remove_node_reference(node& node, const std::string& property_name)
+void remove_node_reference(node& node, const symbol& property_name)
 {
 	assert(node.node_references.contains(property_name) && "Trying to remove a node reference which does not exist");
 	node.node_references.erase(property_name);
 }
-void remove_graph_reference(node& node, const std::string& property_name)
+void remove_graph_reference(node& node, const symbol& property_name)
 {
 	assert(node.graph_references.contains(property_name) && "Trying to remove a graph reference which does not exist");
 	node.graph_references.erase(property_name);
 }
-void remove_texture_reference(node& node, const std::string& property_name)
+void remove_texture_reference(node& node, const symbol& property_name)
 {
 	assert(node.texture_references.contains(property_name) &&
 		   "Trying to remove a texture reference which does not exist");
 	node.texture_references.erase(property_name);
 }
-void remove_input_reference(node& node, const std::string& socket_name)
+void remove_input_reference(node& node, const symbol& socket_name)
 {
 	assert(node.texture_references.contains(socket_name) && "Trying to remove an input reference which does not exist");
 	node.input_references.erase(socket_name);
@@ -170,7 +170,7 @@ namespace std
 size_t hash<nd::edge>::operator()(const nd::edge& edge) const
 {
 	size_t seed = 0;
-	nd::hash_combine(seed, edge.node, edge.socket_name);
+	nd::hash_combine(seed, edge.node, edge.socket_name.name_hash());
 	return seed;
 }
 
@@ -201,7 +201,7 @@ void adl_serializer<edge>::to_json(nd::json& j, const edge& edge)
 void adl_serializer<edge>::from_json(const nd::json& j, edge& edge)
 {
 	edge.node		 = j["node"];
-	edge.socket_name = j["socket"];
+	edge.socket_name = j["socket"].get<symbol>();
 }
 
 void adl_serializer<node>::to_json(nd::json& j, const node& node)
@@ -214,11 +214,11 @@ void adl_serializer<node>::to_json(nd::json& j, const node& node)
 }
 void adl_serializer<node>::from_json(const nd::json& j, node& node)
 {
-	node.node_values		= j["node_values"];
-	node.node_references	= j["node_references"];
-	node.graph_references	= j["graph_references"];
-	node.texture_references = j["texture_references"];
-	node.input_references	= j["input_references"];
+	node.node_values		= j["node_values"].get<property_map<value>>();
+	node.node_references	= j["node_references"].get<property_map<node_ref>>();
+	node.graph_references	= j["graph_references"].get<property_map<graph_ref>>();
+	node.texture_references = j["texture_references"].get<property_map<texture_ref>>();
+	node.input_references	= j["input_references"].get<property_map<edge>>();
 }
 
 void adl_serializer<graph>::to_json(nd::json& j, const graph& graph)
@@ -226,14 +226,16 @@ void adl_serializer<graph>::to_json(nd::json& j, const graph& graph)
 	j = nd::json::object();
 	for (const auto& [node_id, node] : graph.nodes)
 	{
-		j[node_id.name] = node;
+		j[node_id.name()] = node;
 	}
 }
 void adl_serializer<graph>::from_json(const nd::json& j, graph& graph)
 {
+	// Nodes are deserialized in place, so that no temporary copies are allocated (e.g. on an arena, see nd::arena)
+	graph.nodes.reserve(j.size());
 	for (const auto& [node_id, node] : j.items())
 	{
-		add_node(graph, node_ref{.name = node_id}, node);
+		node.get_to(graph.nodes[node_ref{.id = node_id}]);
 	}
 }
 
@@ -242,14 +244,16 @@ void adl_serializer<script>::to_json(nd::json& j, const script& script)
 	j = nd::json::object();
 	for (const auto& [graph_id, graph] : script.graphs)
 	{
-		j[graph_id.name] = graph;
+		j[graph_id.name()] = graph;
 	}
 }
 void adl_serializer<script>::from_json(const nd::json& j, script& script)
 {
+	// Graphs are deserialized in place (see graph's from_json)
+	script.graphs.reserve(j.size());
 	for (const auto& [graph_id, graph] : j.items())
 	{
-		add_graph(script, graph_ref{.name = graph_id}, graph);
+		graph.get_to(script.graphs[graph_ref{.id = graph_id}]);
 	}
 }
 } // namespace nlohmann
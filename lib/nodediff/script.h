@@ -1,8 +1,11 @@
 #pragma once
 #include "reference.h"
+#include "symbol.h"
 #include "utility/types.h"
 #include "value.h"
 
+#include <memory_resource>
+
 // Forward declarations
 namespace nd
 {
@@ -35,7 +38,7 @@ struct edge
 	// node_ref to the node from which the edge starts
 	node_ref node = node_ref::invalid_ref;
 	// the socket from which the edge starts
-	std::string socket_name = "";
+	symbol socket_name = "";
 
 	static const edge invalid_edge;
 
@@ -44,12 +47,14 @@ struct edge
 };
 
 /*
- * Map of properties; for the moment it's just an std::unordered_map always using string as key type.
+ * Map of properties, keyed by property name symbols (see nd::symbol), so that properties are looked up and compared
+ * by integer ids. Since symbols are implicitly constructed from strings, properties can still be looked up by name.
+ * Note: like the other containers of scripts and diffs, it allocates from the default memory resource (see nd::arena).
  */
 template <typename PropertyType>
-struct property_map : std::unordered_map<std::string, PropertyType>
+struct property_map : std::pmr::unordered_map<symbol, PropertyType>
 {
-	using std::unordered_map<std::string, PropertyType>::unordered_map;
+	using std::pmr::unordered_map<symbol, PropertyType>::unordered_map;
 };
 
 /*
@@ -77,11 +82,11 @@ struct node
 
 /*
  * A graph in NodeGit is modeled as an unordered collection of nodes, each of which it is assigned a unique identifier
- * (namely a nd::node_ref). At the moment the unordered collection is an std::unordered_map.
+ * (namely a nd::node_ref). At the moment the unordered collection is an std::pmr::unordered_map.
  */
 struct graph
 {
-	std::unordered_map<node_ref, node> nodes = {};
+	std::pmr::unordered_map<node_ref, node> nodes = {};
 };
 
 /*
@@ -90,7 +95,7 @@ struct graph
  */
 struct script
 {
-	std::unordered_map<graph_ref, graph> graphs = {};
+	std::pmr::unordered_map<graph_ref, graph> graphs = {};
 };
 } // namespace nd
 
@@ -100,42 +105,42 @@ struct script
 namespace nd
 {
 /*
- * Property's getters - get a node's property value/reference by property name
+ * Property's getters - get a node's property value/reference by property name (either a symbol or a string)
  */
-[[nodiscard]] value& get_property_value(node& node, const std::string& property_name);
-[[nodiscard]] const value& get_property_value(const node& node, const std::string& property_name);
-[[nodiscard]] node_ref& get_node_reference(node& node, const std::string& property_name);
-[[nodiscard]] const node_ref& get_node_reference(const node& node, const std::string& property_name);
-[[nodiscard]] graph_ref& get_graph_reference(node& node, const std::string& property_name);
-[[nodiscard]] const graph_ref& get_graph_reference(const node& node, const std::string& property_name);
-[[nodiscard]] texture_ref& get_texture_reference(node& node, const std::string& property_name);
-[[nodiscard]] const texture_ref& get_texture_reference(const node& node, const std::string& property_name);
-[[nodiscard]] edge& get_input_reference(node& node, const std::string& socket_name);
-[[nodiscard]] const edge& get_input_reference(const node& node, const std::string& socket_name);
+[[nodiscard]] value& get_property_value(node& node, const symbol& property_name);
+[[nodiscard]] const value& get_property_value(const node& node, const symbol& property_name);
+[[nodiscard]] node_ref& get_node_reference(node& node, const symbol& property_name);
+[[nodiscard]] const node_ref& get_node_reference(const node& node, const symbol& property_name);
+[[nodiscard]] graph_ref& get_graph_reference(node& node, const symbol& property_name);
+[[nodiscard]] const graph_ref& get_graph_reference(const node& node, const symbol& property_name);
+[[nodiscard]] texture_ref& get_texture_reference(node& node, const symbol& property_name);
+[[nodiscard]] const texture_ref& get_texture_reference(const node& node, const symbol& property_name);
+[[nodiscard]] edge& get_input_reference(node& node, const symbol& socket_name);
+[[nodiscard]] const edge& get_input_reference(const node& node, const symbol& socket_name);
 /*
  * Property's adders - add new property to node with an associated value
  */
-void add_property_value(node& node, const std::string& property_name, const value& value);
-void add_node_reference(node& node, const std::string& property_name, const node_ref& node_reference);
-void add_graph_reference(node& node, const std::string& property_name, const graph_ref& graph_reference);
-void add_texture_reference(node& node, const std::string& property_name, const texture_ref& texture_reference);
-void add_input_reference(node& node, const std::string& socket_name, const edge& input_reference);
+void add_property_value(node& node, const symbol& property_name, const value& value);
+void add_node_reference(node& node, const symbol& property_name, const node_ref& node_reference);
+void add_graph_reference(node& node, const symbol& property_name, const graph_ref& graph_reference);
+void add_texture_reference(node& node, const symbol& property_name, const texture_ref& texture_reference);
+void add_input_reference(node& node, const symbol& socket_name, const edge& input_reference);
 /*
  * Property 's setters - set a new value to an existing node' s property.
  */
-void set_property_value(node& node, const std::string& property_name, const value& value);
-void set_node_reference(node& node, const std::string& property_name, const node_ref& node_reference);
-void set_graph_reference(node& node, const std::string& property_name, const graph_ref& graph_reference);
-void set_texture_reference(node& node, const std::string& property_name, const texture_ref& texture_reference);
-void set_input_reference(node& node, const std::string& socket_name, const edge& input_reference);
+void set_property_value(node& node, const symbol& property_name, const value& value);
+void set_node_reference(node& node, const symbol& property_name, const node_ref& node_reference);
+void set_graph_reference(node& node, const symbol& property_name, const graph_ref& graph_reference);
+void set_texture_reference(node& node, const symbol& property_name, const texture_ref& texture_reference);
+void set_input_reference(node& node, const symbol& socket_name, const edge& input_reference);
 /*
  * Property's removers - remove an existing property from node.
  */
-void remove_property_value(node& node, const std::string& property_name);
-void remove_node_reference(node& node, const std::string& property_name);
-void remove_graph_reference(node& node, const std::string& property_name);
-void remove_texture_reference(node& node, const std::string& property_name);
-void remove_input_reference(node& node, const std::string& socket_name);
+void remove_property_value(node& node, const symbol& property_name);
+void remove_node_reference(node& node, const symbol& property_name);
+void remove_graph_reference(node& node, const symbol& property_name);
+void remove_texture_reference(node& node, const symbol& property_name);
+void remove_input_reference(node& node, const symbol& socket_name);
 
 /*
  * Getter for retrieving node type (to be defined by user).
@@ -204,6 +209,31 @@ ostream& operator<<(ostream& os, const nd::node& node);
 ///
 namespace nlohmann
 {
+/*
+ * Property maps are serialized as json objects keyed by property names.
+ */
+template <typename PropertyType>
+struct adl_serializer<nd::property_map<PropertyType>>
+{
+	static void to_json(nd::json& j, const nd::property_map<PropertyType>& properties)
+	{
+		j = nd::json::object();
+		for (const auto& [property_name, property] : properties)
+		{
+			j[property_name.name()] = property;
+		}
+	}
+	static void from_json(const nd::json& j, nd::property_map<PropertyType>& properties)
+	{
+		properties.clear();
+		properties.reserve(j.size());
+		for (const auto& [property_name, property] : j.items())
+		{
+			properties.emplace(property_name, property.template get<PropertyType>());
+		}
+	}
+};
+
 template <>
 struct adl_serializer<nd::edge>
 {
@@ -0,0 +1,104 @@
+#include "symbol.h"
+
+#include <array>
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace nd
+{
+/*
+ * Process-wide table of the interned names.
+ * Entries are stored in fixed-size chunks which are never moved, so that entries can be read without locking: a thread
+ * can only know an id after the entry got stored (i.e. after interning its name, or after receiving a symbol from the
+ * thread which interned it).
+ */
+class symbol_table
+{
+  public:
+	struct entry
+	{
+		std::string name;
+		size_t name_hash;
+	};
+
+	static symbol_table& instance()
+	{
+		static symbol_table s_instance;
+		return s_instance;
+	}
+
+	// Id of the given name, which is interned if it's new
+	uint32_t intern(std::string_view name)
+	{
+		{
+			std::shared_lock lock(m_mutex);
+			auto id = m_ids.find(name);
+			if (id != m_ids.end()) { return id->second; }
+		}
+		std::unique_lock lock(m_mutex);
+		auto id = m_ids.find(name);
+		if (id != m_ids.end()) { return id->second; }
+
+		assert(m_size < chunk_size * max_chunks && "Too many symbols");
+		const uint32_t new_id = m_size;
+		auto& chunk			  = m_chunks[new_id / chunk_size];
+		if (!chunk) { chunk = std::make_unique<entry[]>(chunk_size); }
+		entry& new_entry	= chunk[new_id % chunk_size];
+		new_entry.name		= name;
+		new_entry.name_hash = std::hash<std::string>()(new_entry.name);
+		// Note: keys are views on the names stored in the entries, which are never moved
+		m_ids.emplace(new_entry.name, new_id);
+		++m_size;
+		return new_id;
+	}
+
+	const entry& get(uint32_t id) const { return m_chunks[id / chunk_size][id % chunk_size]; }
+
+  private:
+	// The empty name always has id 0 (i.e. it's the name of default constructed symbols)
+	symbol_table() { intern(""); }
+
+  private:
+	static constexpr uint32_t chunk_size = 1024;
+	static constexpr uint32_t max_chunks = 4096;
+
+	std::array<std::unique_ptr<entry[]>, max_chunks> m_chunks;
+	std::unordered_map<std::string_view, uint32_t> m_ids;
+	uint32_t m_size = 0;
+	std::shared_mutex m_mutex;
+};
+
+symbol::symbol(std::string_view name) : m_id(symbol_table::instance().intern(name)) {}
+symbol::symbol(const std::string& name) : symbol(std::string_view(name)) {}
+symbol::symbol(const char* name) : symbol(std::string_view(name)) {}
+
+const std::string& symbol::name() const { return symbol_table::instance().get(m_id).name; }
+size_t symbol::name_hash() const { return symbol_table::instance().get(m_id).name_hash; }
+}; // namespace nd
+
+///
+///	STL
+///
+namespace std
+{
+ostream& operator<<(ostream& os, const nd::symbol& symbol)
+{
+	os << symbol.name();
+	return os;
+}
+}; // namespace std
+
+///
+/// Serialization/Deserialization with nlohmann::json
+///
+namespace nlohmann
+{
+void adl_serializer<nd::symbol>::to_json(nd::json& j, const nd::symbol& symbol) { j = symbol.name(); }
+void adl_serializer<nd::symbol>::from_json(const nd::json& j, nd::symbol& symbol)
+{
+	symbol = nd::symbol(j.get_ref<const std::string&>());
+}
+}; // namespace nlohmann
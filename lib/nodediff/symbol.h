@@ -0,0 +1,83 @@
+#pragma once
+#include "utility/types.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+///
+/// Data structures
+///
+namespace nd
+{
+/*
+ * A symbol is an interned string (e.g. a property name), identified by a 32-bit id: all the symbols with the same name
+ * share the same id, so comparing and hashing symbols only compares and hashes integers.
+ * Names are interned in a process-wide symbol table, which is thread-safe and never shrinks (names are expected to be
+ * few, e.g. the property names of the node types in use). Symbols are implicitly constructed from strings, so that
+ * they can be used wherever a name is expected (e.g. node.node_values.at("v.node_name")); constructing a symbol looks
+ * its name up in the symbol table, hence names used in hot paths should be interned once and then reused.
+ *
+ * Note: ids depend on the order in which names are interned, so they must never be persisted (e.g. serialized).
+ */
+class symbol
+{
+  public:
+	// Empty name
+	symbol() = default;
+	symbol(std::string_view name);
+	symbol(const std::string& name);
+	symbol(const char* name);
+
+	// Symbol of the given id (the id must be the id of an interned symbol, e.g. stored by nd::ref_id)
+	[[nodiscard]] static symbol from_id(uint32_t id)
+	{
+		symbol result;
+		result.m_id = id;
+		return result;
+	}
+
+	[[nodiscard]] uint32_t id() const { return m_id; }
+	// Interned name of the symbol
+	[[nodiscard]] const std::string& name() const;
+	// Hash of the symbol's name, equal to std::hash<std::string> of it (unlike the id, it does not depend on the order
+	// in which names are interned, hence it can be used for content hashes)
+	[[nodiscard]] size_t name_hash() const;
+
+	bool operator==(const symbol& other) const { return m_id == other.m_id; }
+	bool operator!=(const symbol& other) const { return m_id != other.m_id; }
+
+  private:
+	uint32_t m_id = 0;
+};
+}; // namespace nd
+
+///
+/// STL
+///
+namespace std
+{
+/*
+ * implementing nd::symbol hashing (note: it hashes the id, see nd::symbol::name_hash for content hashes)
+ */
+template <>
+struct hash<nd::symbol>
+{
+	size_t operator()(const nd::symbol& symbol) const { return symbol.id(); }
+};
+
+ostream& operator<<(ostream& os, const nd::symbol& symbol);
+}; // namespace std
+
+///
+/// Serialization/Deserialization with nlohmann::json
+///
+namespace nlohmann
+{
+template <>
+struct adl_serializer<nd::symbol>
+{
+	static void to_json(nd::json& j, const nd::symbol& symbol);
+	static void from_json(const nd::json& j, nd::symbol& symbol);
+};
+}; // namespace nlohmann
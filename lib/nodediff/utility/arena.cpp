@@ -0,0 +1,86 @@
+#include "arena.h"
+
+namespace nd
+{
+// Generations of the arenas' blocks, 0 is never used (it's the generation of threads without a block)
+static std::atomic<uint64_t> s_next_generation = 1;
+
+/*
+ * Free space of the block from which the thread is currently allocating, i.e. [current, end), valid only while the
+ * block's generation is the current generation of its arena.
+ */
+struct block_cursor
+{
+	uint64_t generation = 0;
+	std::byte* current	= nullptr;
+	std::byte* end		= nullptr;
+};
+static thread_local block_cursor t_cursor;
+
+arena::arena(size_t block_size) : m_block_size(block_size), m_generation(s_next_generation++) {}
+
+void arena::release()
+{
+	std::lock_guard lock(m_mutex);
+	// Threads' cursors on the released blocks become invalid
+	m_generation = s_next_generation++;
+	m_blocks.clear();
+	m_size = 0;
+}
+
+size_t arena::size()
+{
+	std::lock_guard lock(m_mutex);
+	return m_size;
+}
+
+void* arena::do_allocate(size_t bytes, size_t alignment)
+{
+	block_cursor& cursor = t_cursor;
+	if (cursor.generation == m_generation.load(std::memory_order_relaxed))
+	{
+		void* pointer = cursor.current;
+		size_t space  = cursor.end - cursor.current;
+		if (std::align(alignment, bytes, pointer, space))
+		{
+			cursor.current = static_cast<std::byte*>(pointer) + bytes;
+			return pointer;
+		}
+	}
+	return allocate_from_new_block(bytes, alignment);
+}
+
+void* arena::allocate_from_new_block(size_t bytes, size_t alignment)
+{
+	// Big allocations would waste most of a block, hence they get a block of their own
+	const bool is_big		= bytes + alignment > m_block_size / 4;
+	const size_t block_size = is_big ? bytes + alignment : m_block_size;
+	std::byte* block;
+	uint64_t generation;
+	{
+		std::lock_guard lock(m_mutex);
+		block = m_blocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(block_size)).get();
+		m_size += block_size;
+		generation = m_generation;
+	}
+
+	void* pointer = block;
+	size_t space  = block_size;
+	std::align(alignment, bytes, pointer, space);
+	if (!is_big)
+	{
+		t_cursor = {.generation = generation,
+					.current	= static_cast<std::byte*>(pointer) + bytes,
+					.end		= block + block_size};
+	}
+	return pointer;
+}
+
+void arena::do_deallocate(void* pointer, size_t bytes, size_t alignment) {}
+
+bool arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept { return this == &other; }
+
+arena_scope::arena_scope(arena& arena) : m_previous_resource(std::pmr::set_default_resource(&arena)) {}
+
+arena_scope::~arena_scope() { std::pmr::set_default_resource(m_previous_resource); }
+}; // namespace nd
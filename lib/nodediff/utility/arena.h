@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace nd
+{
+/*
+ * Monotonic memory arena: memory is carved out of big blocks and it's never given back one allocation at a time
+ * (deallocation is a no-op), instead all the blocks are released at once when the arena is released or destroyed.
+ * It's thread-safe, so that it can be used by containers filled in parallel (e.g. graphs diffed in parallel): each
+ * thread carves its allocations out of its own block without locking, and only locks the arena to get a new block.
+ *
+ * Scripts, graphs, nodes and diffs store their containers with polymorphic allocators (std::pmr), which allocate from
+ * the default memory resource when they're constructed: an arena_scope makes the arena the default resource, so that
+ * a whole job (e.g. parsing, diffing or merging scripts) allocates from one arena.
+ *
+ * Note: objects allocated from an arena must be destroyed (or never used again) before the arena is released.
+ * Note: a thread keeps a block of one arena at a time, so threads should not allocate from many arenas alternately.
+ */
+class arena : public std::pmr::memory_resource
+{
+  public:
+	// Size of the blocks (bigger allocations get a block of their own)
+	static constexpr size_t default_block_size = 1024 * 1024;
+
+	explicit arena(size_t block_size = default_block_size);
+	arena(const arena& other) = delete;
+	arena(arena&& other)	  = delete;
+
+	// Releases all the memory allocated from the arena
+	void release();
+	// Number of bytes of the blocks held by the arena
+	[[nodiscard]] size_t size();
+
+  private:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+	[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	// Allocates from a new block, which becomes the block of the calling thread unless the allocation is big
+	void* allocate_from_new_block(size_t bytes, size_t alignment);
+
+  private:
+	const size_t m_block_size;
+	// Identifies the blocks currently held by the arena (unique among all arenas, it changes when they're released)
+	std::atomic<uint64_t> m_generation;
+	std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+	size_t m_size = 0;
+	// Guards the blocks
+	std::mutex m_mutex;
+};
+
+/*
+ * Scoped default memory resource, this means that the given arena is the default memory resource (see
+ * std::pmr::get_default_resource) from construction to destruction, when the previous default resource is restored.
+ */
+class arena_scope
+{
+  public:
+	explicit arena_scope(arena& arena);
+	arena_scope(const arena_scope& other) = delete;
+	arena_scope(arena_scope&& other)	  = delete;
+	~arena_scope();
+
+  private:
+	std::pmr::memory_resource* m_previous_resource;
+};
+}; // namespace nd
@@ -0,0 +1,167 @@
+#pragma once
+#include "types.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+namespace nd
+{
+/*
+ * Vector of trivially copyable elements which stores up to N elements inline, i.e. without allocating them on the heap.
+ * It is meant for short arrays whose size rarely exceeds N (e.g. Blender's vectors and colors), which are then copied
+ * without any allocation.
+ */
+template <typename T, size_t N>
+class small_vector
+{
+	static_assert(std::is_trivially_copyable_v<T>, "small_vector elements must be trivially copyable");
+
+  public:
+	using value_type	 = T;
+	using iterator		 = T*;
+	using const_iterator = const T*;
+
+	small_vector() = default;
+	small_vector(std::initializer_list<T> elements) { assign(elements.begin(), elements.size()); }
+	explicit small_vector(const std::vector<T>& elements) { assign(elements.data(), elements.size()); }
+	small_vector(const small_vector& other) { assign(other.data(), other.size()); }
+	small_vector(small_vector&& other) noexcept { steal(other); }
+	~small_vector() { release(); }
+
+	small_vector& operator=(const small_vector& other)
+	{
+		if (this != &other) { assign(other.data(), other.size()); }
+		return *this;
+	}
+	small_vector& operator=(small_vector&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+			steal(other);
+		}
+		return *this;
+	}
+
+	[[nodiscard]] size_t size() const { return m_size; }
+	[[nodiscard]] bool empty() const { return m_size == 0; }
+	[[nodiscard]] T* data() { return is_inline() ? m_inline : m_heap; }
+	[[nodiscard]] const T* data() const { return is_inline() ? m_inline : m_heap; }
+
+	iterator begin() { return data(); }
+	iterator end() { return data() + m_size; }
+	const_iterator begin() const { return data(); }
+	const_iterator end() const { return data() + m_size; }
+
+	T& operator[](size_t idx) { return data()[idx]; }
+	const T& operator[](size_t idx) const { return data()[idx]; }
+
+	void push_back(T element)
+	{
+		if (m_size == m_capacity) { reserve(2 * m_capacity); }
+		data()[m_size++] = element;
+	}
+	void resize(size_t size)
+	{
+		reserve(size);
+		std::fill(data() + m_size, data() + std::max<size_t>(size, m_size), T{});
+		m_size = static_cast<uint32_t>(size);
+	}
+	void reserve(size_t capacity)
+	{
+		if (capacity <= m_capacity) { return; }
+		T* heap = new T[capacity];
+		std::memcpy(heap, data(), m_size * sizeof(T));
+		release();
+		m_heap	   = heap;
+		m_capacity = static_cast<uint32_t>(capacity);
+	}
+	void clear() { m_size = 0; }
+
+	[[nodiscard]] std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+
+	bool operator==(const small_vector& other) const
+	{
+		return m_size == other.m_size && std::equal(begin(), end(), other.begin());
+	}
+	bool operator==(const std::vector<T>& other) const
+	{
+		return m_size == other.size() && std::equal(begin(), end(), other.begin());
+	}
+	bool operator!=(const small_vector& other) const { return !(*this == other); }
+	bool operator!=(const std::vector<T>& other) const { return !(*this == other); }
+
+  private:
+	[[nodiscard]] bool is_inline() const { return m_capacity == N; }
+
+	// Replace the elements with a copy of the given ones (which must not be stored by this vector)
+	void assign(const T* elements, size_t size)
+	{
+		if (size > m_capacity)
+		{
+			release();
+			m_heap	   = new T[size];
+			m_capacity = static_cast<uint32_t>(size);
+		}
+		std::memcpy(data(), elements, size * sizeof(T));
+		m_size = static_cast<uint32_t>(size);
+	}
+	// Take the elements of another vector, which is left empty (this vector must not own heap elements)
+	void steal(small_vector& other)
+	{
+		if (other.is_inline()) { std::memcpy(m_inline, other.m_inline, other.m_size * sizeof(T)); }
+		else { m_heap = other.m_heap; }
+		m_size			 = other.m_size;
+		m_capacity		 = other.m_capacity;
+		other.m_size	 = 0;
+		other.m_capacity = N;
+	}
+	// Free the heap elements (if any), the vector gets back to its inline storage
+	void release()
+	{
+		if (!is_inline()) { delete[] m_heap; }
+		m_capacity = N;
+	}
+
+  private:
+	union
+	{
+		T m_inline[N];
+		T* m_heap;
+	};
+	uint32_t m_size		= 0;
+	uint32_t m_capacity = N; // N while elements are stored inline
+};
+}; // namespace nd
+
+///
+/// Serialization/Deserialization with nlohmann::json
+///
+namespace nlohmann
+{
+template <typename T, size_t N>
+struct adl_serializer<nd::small_vector<T, N>>
+{
+	static void to_json(nd::json& j, const nd::small_vector<T, N>& elements)
+	{
+		j = nd::json::array();
+		for (const T& element : elements)
+		{
+			j.push_back(element);
+		}
+	}
+	static void from_json(const nd::json& j, nd::small_vector<T, N>& elements)
+	{
+		elements.clear();
+		elements.reserve(j.size());
+		for (const nd::json& element : j)
+		{
+			elements.push_back(element.get<T>());
+		}
+	}
+};
+} // namespace nlohmann
@@ -1,6 +1,8 @@
 #pragma once
 #include "types.h"
 
+#include <mutex>
+
 namespace nd
 {
 /*
@@ -11,6 +13,8 @@ class statistics_collector
 {
   public:
 	nd::json json;
+	// Guards json when statistics are collected by many threads (e.g. graphs diffed in parallel)
+	std::mutex mutex;
 
   public:
 	statistics_collector(const statistics_collector& other) = delete;
@@ -31,8 +31,9 @@ inline void hash_combine(out_var size_t& seed, const T& v, const Rest&... rest)
 * auto m2 = {1: "earth"};
 * nd::update(m1, m2); => m1 <- {0: "hello", 1: "earth"}
 */
-template <typename K, typename V>
-inline void update(std::unordered_map<K, V>& m1, const std::unordered_map<K, V>& m2)
+template <typename K, typename V, typename Hash, typename Equal, typename Allocator>
+inline void update(std::unordered_map<K, V, Hash, Equal, Allocator>& m1,
+				   const std::unordered_map<K, V, Hash, Equal, Allocator>& m2)
 {
 	for (const auto& [k2, v2] : m2)
 	{
@@ -13,6 +13,8 @@ class uuid
 	uuid();
 	// Returns uuid formatted as string
 	[[nodiscard]] std::string string();
+	// Returns the 16 bytes of the uuid
+	[[nodiscard]] const unsigned char* data() const { return m_data; }
   private:
 	unsigned char m_data[16] = {0};
 };
@@ -1,34 +1,86 @@
 #include "value.h"
 
+#include "utility/utility.h"
+
 #include <assert.h>
+#include <utility>
 
 namespace nd
 {
-value::value(const value& value)
-	: m_type(value.m_type), m_boolean(value.m_boolean), m_float_nums(value.m_float_nums), m_int_nums(value.m_int_nums),
-	  m_string(value.m_string), m_list(value.m_list), m_dictionary(value.m_dictionary)
+void value::reset()
 {
+	switch (m_type)
+	{
+	case type::float_array: m_float_nums.~float_array(); break;
+	case type::int_array: m_int_nums.~int_array(); break;
+	case type::string: m_string.~basic_string(); break;
+	case type::list: m_list.~list(); break;
+	case type::dictionary: delete m_dictionary; break;
+	default: break;
+	}
+	m_type = type::none;
 }
 
-value::value(value&& value)
-	: m_type(value.m_type), m_boolean(std::move(value.m_boolean)), m_float_nums(std::move(value.m_float_nums)),
-	  m_int_nums(std::move(value.m_int_nums)), m_string(std::move(value.m_string)), m_list(std::move(value.m_list)),
-	  m_dictionary(std::move(value.m_dictionary))
+void value::construct_from(const value& other)
 {
-	value.m_type = value::type::none;
+	switch (other.m_type)
+	{
+	case type::none: break;
+	case type::boolean: m_boolean = other.m_boolean; break;
+	case type::float_number: m_float_num = other.m_float_num; break;
+	case type::float_array: new (&m_float_nums) float_array(other.m_float_nums); break;
+	case type::int_number: m_int_num = other.m_int_num; break;
+	case type::int_array: new (&m_int_nums) int_array(other.m_int_nums); break;
+	case type::string: new (&m_string) std::string(other.m_string); break;
+	case type::list: new (&m_list) list(other.m_list); break;
+	case type::dictionary: m_dictionary = new dictionary(*other.m_dictionary); break;
+	default: assert(false && "Invalid type");
+	}
+	m_type = other.m_type;
 }
+
+void value::construct_from(value&& other)
+{
+	switch (other.m_type)
+	{
+	case type::none: break;
+	case type::boolean: m_boolean = other.m_boolean; break;
+	case type::float_number: m_float_num = other.m_float_num; break;
+	case type::float_array: new (&m_float_nums) float_array(std::move(other.m_float_nums)); break;
+	case type::int_number: m_int_num = other.m_int_num; break;
+	case type::int_array: new (&m_int_nums) int_array(std::move(other.m_int_nums)); break;
+	case type::string: new (&m_string) std::string(std::move(other.m_string)); break;
+	case type::list: new (&m_list) list(std::move(other.m_list)); break;
+	// The dictionary is handed over, hence other must not delete it
+	case type::dictionary: m_dictionary = std::exchange(other.m_dictionary, nullptr); break;
+	default: assert(false && "Invalid type");
+	}
+	m_type = other.m_type;
+	other.reset();
+}
+
+value::value(const value& value) { construct_from(value); }
+
+value::value(value&& value) noexcept { construct_from(std::move(value)); }
+
+value::~value() { reset(); }
+
 // None
 value::value() : m_type(type::none) {}
 // Boolean
 value::value(bool boolean) : m_type(type::boolean), m_boolean(boolean) {}
 // Float - Float Array
-value::value(float float_num) : m_type(type::float_number), m_float_nums({float_num}) {}
+value::value(float float_num) : m_type(type::float_number), m_float_num(float_num) {}
 value::value(const std::vector<float>& float_nums) : m_type(type::float_array), m_float_nums(float_nums) {}
-value::value(std::vector<float>&& float_nums) : m_type(type::float_array), m_float_nums(std::move(float_nums)) {}
+value::value(std::vector<float>&& float_nums) : m_type(type::float_array), m_float_nums(float_nums) {}
+value::value(const float_array& float_nums) : m_type(type::float_array), m_float_nums(float_nums) {}
+value::value(float_array&& float_nums) : m_type(type::float_array), m_float_nums(std::move(float_nums)) {}
 // Int - Int Array
-value::value(int int_num) : m_type(type::int_number), m_int_nums({int_num}) {}
+value::value(int int_num) : m_type(type::int_number), m_int_num(int_num) {}
 value::value(const std::vector<int>& int_nums) : m_type(type::int_array), m_int_nums(int_nums) {}
-value::value(std::vector<int>&& int_nums) : m_type(type::int_array), m_int_nums(std::move(int_nums)) {}
+value::value(std::vector<int>&& int_nums) : m_type(type::int_array), m_int_nums(int_nums) {}
+value::value(const int_array& int_nums) : m_type(type::int_array), m_int_nums(int_nums) {}
+value::value(int_array&& int_nums) : m_type(type::int_array), m_int_nums(std::move(int_nums)) {}
 // String
 value::value(const std::string& string) : m_type(type::string), m_string(string) {}
 value::value(std::string&& string) : m_type(type::string), m_string(std::move(string)) {}
@@ -36,8 +88,11 @@ value::value(std::string&& string) : m_type(type::string), m_string(std::move(st
 value::value(const list& list) : m_type(type::list), m_list(list) {}
 value::value(list&& list) : m_type(type::list), m_list(std::move(list)) {}
 // Dictionary
-value::value(const dictionary& dictionary) : m_type(type::dictionary), m_dictionary(dictionary) {}
-value::value(dictionary&& dictionary) : m_type(type::dictionary), m_dictionary(std::move(dictionary)) {}
+value::value(const dictionary& dictionary) : m_type(type::dictionary), m_dictionary(new nd::dictionary(dictionary)) {}
+value::value(dictionary&& dictionary)
+	: m_type(type::dictionary), m_dictionary(new nd::dictionary(std::move(dictionary)))
+{
+}
 
 template <>
 bool& value::get()
@@ -57,25 +112,25 @@ template <>
 float& value::get()
 {
 	assert(m_type == type::float_number && "Type requested is different from m_type");
-	return m_float_nums[0];
+	return m_float_num;
 }
 
 template <>
 const float& value::get() const
 {
 	assert(m_type == type::float_number && "Type requested is different from m_type");
-	return m_float_nums[0];
+	return m_float_num;
 }
 
 template <>
-std::vector<float>& value::get()
+float_array& value::get()
 {
 	assert(m_type == type::float_array && "Type requested is different from m_type");
 	return m_float_nums;
 }
 
 template <>
-const std::vector<float>& value::get() const
+const float_array& value::get() const
 {
 	assert(m_type == type::float_array && "Type requested is different from m_type");
 	return m_float_nums;
@@ -85,25 +140,25 @@ template <>
 int& value::get()
 {
 	assert(m_type == type::int_number && "Type requested is different from m_type");
-	return m_int_nums[0];
+	return m_int_num;
 }
 
 template <>
 const int& value::get() const
 {
 	assert(m_type == type::int_number && "Type requested is different from m_type");
-	return m_int_nums[0];
+	return m_int_num;
 }
 
 template <>
-std::vector<int>& value::get()
+int_array& value::get()
 {
 	assert(m_type == type::int_array && "Type requested is different from m_type");
 	return m_int_nums;
 }
 
 template <>
-const std::vector<int>& value::get() const
+const int_array& value::get() const
 {
 	assert(m_type == type::int_array && "Type requested is different from m_type");
 	return m_int_nums;
@@ -141,150 +196,58 @@ template <>
 dictionary& value::get()
 {
 	assert(m_type == type::dictionary && "Type requested is different from m_type");
-	return m_dictionary;
+	return *m_dictionary;
 }
 
 template <>
 const dictionary& value::get() const
 {
 	assert(m_type == type::dictionary && "Type requested is different from m_type");
-	return m_dictionary;
+	return *m_dictionary;
 }
 
+// Note: the assigned value is copied (or moved) before resetting this one, since it may be owned by this one (e.g. it
+// may be an element of this value's list)
 value& value::operator=(const value& value)
 {
-	m_type = value.m_type;
-	switch (value.m_type)
-	{
-	case type::none: break;
-	case type::boolean: m_boolean = value.m_boolean; break;
-	case type::float_number:
-		m_float_nums.resize(1);
-		m_float_nums[0] = value.m_float_nums[0];
-		break;
-	case type::float_array: m_float_nums = value.m_float_nums; break;
-	case type::int_number:
-		m_int_nums.resize(1);
-		m_int_nums[0] = value.m_int_nums[0];
-		break;
-	case type::int_array: m_int_nums = value.m_int_nums; break;
-	case type::string: m_string = value.m_string; break;
-	case type::list: m_list = value.m_list; break;
-	case type::dictionary: m_dictionary = value.m_dictionary; break;
-	default: assert(false && "Invalid type");
-	}
+	if (this == &value) { return *this; }
+	nd::value copy(value);
+	reset();
+	construct_from(std::move(copy));
 	return *this;
 }
 
 value& value::operator=(value&& value)
 {
-	m_type = value.m_type;
-	switch (value.m_type)
-	{
-	case type::none: break;
-	case type::boolean: m_boolean = std::move(value.m_boolean); break;
-	case type::float_number:
-	case type::float_array: m_float_nums = std::move(value.m_float_nums); break;
-	case type::int_number:
-	case type::int_array: m_int_nums = std::move(value.m_int_nums); break;
-	case type::string: m_string = std::move(value.m_string); break;
-	case type::list: m_list = std::move(value.m_list); break;
-	case type::dictionary: m_dictionary = std::move(value.m_dictionary); break;
-	default: assert(false && "Invalid type");
-	}
-	return *this;
-}
-
-value& value::operator=(bool boolean)
-{
-	m_type	  = value::type::boolean;
-	m_boolean = boolean;
-	return *this;
-}
-
-value& value::operator=(float float_num)
-{
-	m_type		 = value::type::float_number;
-	m_float_nums = {float_num};
-	return *this;
-}
-
-value& value::operator=(const std::vector<float>& float_nums)
-{
-	m_type		 = value::type::float_array;
-	m_float_nums = float_nums;
-	return *this;
-}
-
-value& value::operator=(std::vector<float>&& float_nums)
-{
-	m_type		 = value::type::float_array;
-	m_float_nums = std::move(float_nums);
-	return *this;
-}
-
-value& value::operator=(int int_num)
-{
-	m_type	   = value::type::int_number;
-	m_int_nums = {int_num};
+	if (this == &value) { return *this; }
+	nd::value moved(std::move(value));
+	reset();
+	construct_from(std::move(moved));
 	return *this;
 }
 
-value& value::operator=(const std::vector<int>& int_nums)
-{
-	m_type	   = value::type::int_array;
-	m_int_nums = int_nums;
-	return *this;
-}
+value& value::operator=(bool boolean) { return *this = value(boolean); }
 
-value& value::operator=(std::vector<int>&& int_nums)
-{
-	m_type	   = value::type::int_array;
-	m_int_nums = std::move(int_nums);
-	return *this;
-}
+value& value::operator=(float float_num) { return *this = value(float_num); }
+value& value::operator=(const std::vector<float>& float_nums) { return *this = value(float_nums); }
+value& value::operator=(std::vector<float>&& float_nums) { return *this = value(float_nums); }
+value& value::operator=(const float_array& float_nums) { return *this = value(float_nums); }
+value& value::operator=(float_array&& float_nums) { return *this = value(std::move(float_nums)); }
 
-value& value::operator=(const std::string& string)
-{
-	m_type	 = value::type::string;
-	m_string = string;
-	return *this;
-}
+value& value::operator=(int int_num) { return *this = value(int_num); }
+value& value::operator=(const std::vector<int>& int_nums) { return *this = value(int_nums); }
+value& value::operator=(std::vector<int>&& int_nums) { return *this = value(int_nums); }
+value& value::operator=(const int_array& int_nums) { return *this = value(int_nums); }
+value& value::operator=(int_array&& int_nums) { return *this = value(std::move(int_nums)); }
 
-value& value::operator=(std::string&& string)
-{
-	m_type	 = value::type::string;
-	m_string = std::move(string);
-	return *this;
-}
-
-value& value::operator=(const list& list)
-{
-	m_type = value::type::list;
-	m_list = list;
-	return *this;
-}
-
-value& value::operator=(list&& list)
-{
-	m_type = value::type::list;
-	m_list = std::move(list);
-	return *this;
-}
+value& value::operator=(const std::string& string) { return *this = value(string); }
+value& value::operator=(std::string&& string) { return *this = value(std::move(string)); }
 
-value& value::operator=(const dictionary& dictionary)
-{
-	m_type		 = value::type::dictionary;
-	m_dictionary = dictionary;
-	return *this;
-}
+value& value::operator=(const list& list) { return *this = value(list); }
+value& value::operator=(list&& list) { return *this = value(std::move(list)); }
 
-value& value::operator=(dictionary&& dictionary)
-{
-	m_type		 = value::type::dictionary;
-	m_dictionary = std::move(dictionary);
-	return *this;
-}
+value& value::operator=(const dictionary& dictionary) { return *this = value(dictionary); }
+value& value::operator=(dictionary&& dictionary) { return *this = value(std::move(dictionary)); }
 bool value::operator==(const value& other) const
 {
 	if (m_type != other.m_type) return false;
@@ -292,41 +255,48 @@ bool value::operator==(const value& other) const
 	{
 	case type::none: return true;
 	case type::boolean: return m_boolean == other.m_boolean;
-	case type::float_number:
+	case type::float_number: return m_float_num == other.m_float_num;
 	case type::float_array: return m_float_nums == other.m_float_nums;
-	case type::int_number:
+	case type::int_number: return m_int_num == other.m_int_num;
 	case type::int_array: return m_int_nums == other.m_int_nums;
 	case type::string: return m_string == other.m_string;
 	case type::list: return m_list == other.m_list;
-	case type::dictionary: return m_dictionary == other.m_dictionary;
+	case type::dictionary: return *m_dictionary == *other.m_dictionary;
 	default: assert(false && "Invalid value type");
 	}
 	return false;
 }
 bool value::operator==(bool other) const { return m_type == value::type::boolean && m_boolean == other; }
-bool value::operator==(float other) const { return m_type == value::type::float_number && m_float_nums[0] == other; }
+bool value::operator==(float other) const { return m_type == value::type::float_number && m_float_num == other; }
 bool value::operator==(const std::vector<float>& other) const
 {
 	return m_type == value::type::float_array && m_float_nums == other;
 }
-bool value::operator==(int other) const { return m_type == value::type::int_number && m_int_nums[0] == other; }
+bool value::operator==(const float_array& other) const
+{
+	return m_type == value::type::float_array && m_float_nums == other;
+}
+bool value::operator==(int other) const { return m_type == value::type::int_number && m_int_num == other; }
 bool value::operator==(const std::vector<int>& other) const
 {
 	return m_type == value::type::int_array && m_int_nums == other;
 }
+bool value::operator==(const int_array& other) const { return m_type == value::type::int_array && m_int_nums == other; }
 bool value::operator==(const char* other) const { return m_type == value::type::string && m_string == other; }
 bool value::operator==(const std::string& other) const { return m_type == value::type::string && m_string == other; }
 bool value::operator==(const list& other) const { return m_type == value::type::list && m_list == other; }
 bool value::operator==(const dictionary& other) const
 {
-	return m_type == value::type::dictionary && m_dictionary == other;
+	return m_type == value::type::dictionary && *m_dictionary == other;
 }
 bool value::operator!=(const value& other) const { return !(*this == other); }
 bool value::operator!=(bool other) const { return !(*this == other); }
 bool value::operator!=(float other) const { return !(*this == other); }
 bool value::operator!=(const std::vector<float>& other) const { return !(*this == other); }
+bool value::operator!=(const float_array& other) const { return !(*this == other); }
 bool value::operator!=(int other) const { return !(*this == other); }
 bool value::operator!=(const std::vector<int>& other) const { return !(*this == other); }
+bool value::operator!=(const int_array& other) const { return !(*this == other); }
 bool value::operator!=(const char* other) const { return !(*this == other); }
 bool value::operator!=(const std::string& other) const { return !(*this == other); }
 bool value::operator!=(const list& other) const { return !(*this == other); }
@@ -338,6 +308,51 @@ bool value::operator!=(const dictionary& other) const { return !(*this == other)
 ///
 namespace std
 {
+size_t hash<nd::value>::operator()(const nd::value& value) const
+{
+	size_t seed = 0;
+	nd::hash_combine(seed, static_cast<int>(value.type()));
+	switch (value.type())
+	{
+	case nd::value::type::none: break;
+	case nd::value::type::boolean: nd::hash_combine(seed, value.get<bool>()); break;
+	case nd::value::type::float_number: nd::hash_combine(seed, value.get<float>()); break;
+	case nd::value::type::float_array:
+		for (float float_num : value.get<nd::float_array>())
+		{
+			nd::hash_combine(seed, float_num);
+		}
+		break;
+	case nd::value::type::int_number: nd::hash_combine(seed, value.get<int>()); break;
+	case nd::value::type::int_array:
+		for (int int_num : value.get<nd::int_array>())
+		{
+			nd::hash_combine(seed, int_num);
+		}
+		break;
+	case nd::value::type::string: nd::hash_combine(seed, value.get<std::string>()); break;
+	case nd::value::type::list:
+		for (const nd::value& element : value.get<nd::list>())
+		{
+			nd::hash_combine(seed, element);
+		}
+		break;
+	case nd::value::type::dictionary: {
+		// Entries are combined by sum, so that the hash does not depend on their order
+		size_t entries_hash = 0;
+		for (const auto& [key, element] : value.get<nd::dictionary>())
+		{
+			size_t entry_seed = 0;
+			nd::hash_combine(entry_seed, key, element);
+			entries_hash += entry_seed;
+		}
+		nd::hash_combine(seed, entries_hash);
+		break;
+	}
+	}
+	return seed;
+}
+
 ostream& operator<<(ostream& os, const nd::value& value)
 {
 	os << nd::json(value);
@@ -357,9 +372,9 @@ void adl_serializer<nd::value>::to_json(nd::json& j, const nd::value& value)
 	{
 	case value::type::boolean: j = value.get<bool>(); break;
 	case value::type::float_number: j = value.get<float>(); break;
-	case value::type::float_array: j = value.get<std::vector<float>>(); break;
+	case value::type::float_array: j = value.get<float_array>(); break;
 	case value::type::int_number: j = value.get<int>(); break;
-	case value::type::int_array: j = value.get<std::vector<int>>(); break;
+	case value::type::int_array: j = value.get<int_array>(); break;
 	case value::type::string: j = value.get<std::string>(); break;
 	case value::type::list: j = value.get<nd::list>(); break;
 	case value::type::dictionary: j = value.get<nd::dictionary>(); break;
@@ -377,10 +392,10 @@ void adl_serializer<nd::value>::from_json(const nd::json& j, nd::value& value)
 
 		if (array_size >= 1 && j[0].is_number())
 		{
-			if (j[0].is_number_float()) { value = j.get<std::vector<float>>(); }
+			if (j[0].is_number_float()) { value = j.get<float_array>(); }
 			else
 			{
-				value = j.get<std::vector<int>>();
+				value = j.get<int_array>();
 			}
 		}
 		else
@@ -1,8 +1,8 @@
 #pragma once
+#include "utility/small_vector.h"
 #include "utility/types.h"
 
 #include <unordered_map>
-#include <variant>
 #include <vector>
 
 // Variadic type value declaration
@@ -23,7 +23,14 @@ struct list : public std::vector<value>
 	using std::vector<value>::vector;
 };
 
-// Variadic type value
+// Arrays of numbers (short ones, e.g. Blender's vectors and colors, are stored inline)
+using float_array = small_vector<float, 4>;
+using int_array	  = small_vector<int, 4>;
+
+/*
+ * Variadic type value, stored as a tagged union: only the member of the current type is alive.
+ * Note: dictionaries are rare, hence they're stored on the heap so that they don't make all the other values bigger.
+ */
 class value
 {
   public:
@@ -41,23 +48,33 @@ class value
 	};
 
   private:
-	type m_type = type::none; // current value's type
+	type m_type = type::none; // current value's type, i.e. the alive member of the union
 
-	bool m_boolean					= false;
-	std::vector<float> m_float_nums = {};
-	std::vector<int> m_int_nums		= {};
-	std::string m_string			= "";
-	list m_list						= {};
-	dictionary m_dictionary			= {};
+	union
+	{
+		bool m_boolean;
+		float m_float_num;
+		float_array m_float_nums;
+		int m_int_num;
+		int_array m_int_nums;
+		std::string m_string;
+		list m_list;
+		dictionary* m_dictionary;
+	};
 
-  public:
-	// Default constructor disabled, use custom ones
-	value(type, bool, std::vector<float>, std::vector<int>, std::string, list, dictionary) = delete;
+	// Destroy the alive member of the union, the value becomes none
+	void reset();
+	// Construct the union member of other's type, by copying or moving other's one (the value must be none)
+	void construct_from(const value& other);
+	void construct_from(value&& other);
 
+  public:
 	// Copy constructor
 	value(const value& value);
-	// Move constructor
-	value(value&& value);
+	// Move constructor (the moved value becomes none)
+	value(value&& value) noexcept;
+	// Destructor
+	~value();
 
 	// Constructors for each value type
 	value();
@@ -65,9 +82,13 @@ class value
 	value(float float_num);
 	value(const std::vector<float>& float_nums);
 	value(std::vector<float>&& float_nums);
+	value(const float_array& float_nums);
+	value(float_array&& float_nums);
 	value(int int_num);
 	value(const std::vector<int>& int_nums);
 	value(std::vector<int>&& int_nums);
+	value(const int_array& int_nums);
+	value(int_array&& int_nums);
 	value(const std::string& string);
 	value(std::string&& string);
 	value(const list& list);
@@ -79,6 +100,7 @@ class value
 	/*
 	* It returns the currently value stored by the struct but casted to its current type associated.
 	* Example, nd::value v storing an integer: int a = v.get<int>();
+	* Note: arrays are returned as nd::float_array and nd::int_array.
 	*/
 	template <typename T>
 	T& get();
@@ -99,10 +121,14 @@ class value
 	value& operator=(float float_num);
 	value& operator=(const std::vector<float>& float_nums);
 	value& operator=(std::vector<float>&& float_nums);
+	value& operator=(const float_array& float_nums);
+	value& operator=(float_array&& float_nums);
 
 	value& operator=(int int_num);
 	value& operator=(const std::vector<int>& int_nums);
 	value& operator=(std::vector<int>&& int_nums);
+	value& operator=(const int_array& int_nums);
+	value& operator=(int_array&& int_nums);
 
 	value& operator=(const std::string& string);
 	value& operator=(std::string&& string);
@@ -118,8 +144,10 @@ class value
 	bool operator==(bool other) const;
 	bool operator==(float other) const;
 	bool operator==(const std::vector<float>& other) const;
+	bool operator==(const float_array& other) const;
 	bool operator==(int other) const;
 	bool operator==(const std::vector<int>& other) const;
+	bool operator==(const int_array& other) const;
 	bool operator==(const char* other) const;
 	bool operator==(const std::string& other) const;
 	bool operator==(const list& other) const;
@@ -130,8 +158,10 @@ class value
 	bool operator!=(bool other) const;
 	bool operator!=(float other) const;
 	bool operator!=(const std::vector<float>& other) const;
+	bool operator!=(const float_array& other) const;
 	bool operator!=(int other) const;
 	bool operator!=(const std::vector<int>& other) const;
+	bool operator!=(const int_array& other) const;
 	bool operator!=(const char* other) const;
 	bool operator!=(const std::string& other) const;
 	bool operator!=(const list& other) const;
@@ -144,6 +174,15 @@ class value
 ///
 namespace std
 {
+/*
+ * implementing nd::value hashing
+ */
+template <>
+struct hash<nd::value>
+{
+	size_t operator()(const nd::value& value) const;
+};
+
 ostream& operator<<(ostream& os, const nd::value& value);
 }
 
@@ -0,0 +1,89 @@
+/*
+ * Benchmark of allocating scripts from a memory arena (see nd::arena), given a NodeDiff's script (json).
+ * Each job deserializes the script, copies it, and then releases both, either on the global heap or on an arena; the
+ * time of each step is measured for the first job (i.e. in a fresh process, like a nd_blender command) and as the
+ * median over multiple jobs (i.e. in a long-running process, where the heap reuses the memory freed by previous jobs).
+ */
+#include <nodediff/script.h>
+#include <nodediff/utility/arena.h>
+#include <nodediff/utility/utility.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace nd;
+
+// Milliseconds elapsed since the given time point (nd::timer only has a resolution of milliseconds)
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct job_times
+{
+	std::vector<double> deserialize = {};
+	std::vector<double> copy		= {};
+	std::vector<double> release		= {};
+};
+
+// Deserializes and copies the script, then releases both (on an arena if use_arena is true)
+static void run_job(const json& script_json, bool use_arena, job_times& times)
+{
+	nd::arena arena;
+	std::optional<nd::arena_scope> arena_scope;
+	if (use_arena) { arena_scope.emplace(arena); }
+	std::optional<script> script, copy;
+
+	auto deserialize_start = std::chrono::steady_clock::now();
+	script				   = script_json.get<nd::script>();
+	times.deserialize.push_back(milliseconds_since(deserialize_start));
+
+	auto copy_start = std::chrono::steady_clock::now();
+	copy			= *script;
+	times.copy.push_back(milliseconds_since(copy_start));
+
+	auto release_start = std::chrono::steady_clock::now();
+	script.reset();
+	copy.reset();
+	arena.release();
+	times.release.push_back(milliseconds_since(release_start));
+}
+
+int main(int argc, const char** argv)
+{
+	if (argc < 3 || (std::string(argv[2]) != "heap" && std::string(argv[2]) != "arena"))
+	{
+		std::cerr << "Usage: arena_benchmark <nd_script.json> <heap|arena> [repeats]" << std::endl;
+		return 1;
+	}
+	const bool use_arena = std::string(argv[2]) == "arena";
+	const int repeats	 = argc > 3 ? std::stoi(argv[3]) : 10;
+	json script_json;
+	if (!load_json(argv[1], script_json))
+	{
+		std::cerr << "Failed to load json at: " << argv[1] << std::endl;
+		return 1;
+	}
+
+	job_times times;
+	for (int repeat = 0; repeat < repeats; ++repeat)
+	{
+		run_job(script_json, use_arena, times);
+	}
+	auto median = [](std::vector<double> times) {
+		std::sort(times.begin(), times.end());
+		return times[times.size() / 2];
+	};
+	std::cout << "job\tdeserialize\tcopy\trelease\ttotal" << std::endl;
+	auto print_times = [](const char* job, double deserialize, double copy, double release) {
+		std::cout << job << "\t" << deserialize << " ms\t" << copy << " ms\t" << release << " ms\t"
+				  << deserialize + copy + release << " ms" << std::endl;
+	};
+	print_times("first", times.deserialize.front(), times.copy.front(), times.release.front());
+	print_times("median", median(times.deserialize), median(times.copy), median(times.release));
+	return 0;
+}
@@ -0,0 +1,79 @@
+import argparse
+import json
+import statistics
+import tempfile
+
+import matching_scaling
+from matching_scaling import run_timed_diff, node_matching_time
+from matching_quality import final_node_match_cost
+
+
+def node_cost_evaluations(stats):
+    """
+    Returns the total number of node edit cost evaluations, given the statistics of a diff.
+    """
+    return sum(match["cost_evaluations"] for match in stats["matches"] if "node_ref" in match["match_type"])
+
+def node_changes(diff):
+    """
+    Returns the set of node changes of a diff, as (graph id, node id, serialized node change) tuples.
+    """
+    changes = set()
+    for graph_id, graph_change in diff.items():
+        if graph_change["operation"] != "edit":
+            continue
+        for node_id, node_change in graph_change["diff"].items():
+            changes.add((graph_id, node_id, json.dumps(node_change, sort_keys=True)))
+    return changes
+
+def run_lsh_benchmark(nd_ancestor_fp, nd_version_fp, configurations, repeats):
+    """
+    Diffs the same pair of nd::script objects with the exact matcher (i.e. without candidate pruning) and with MinHash
+    LSH candidate pruning, using each <bands, rows> configuration. It prints node matching time (median over repeats
+    runs), node edit cost evaluations, final node matching cost and recall for each of them.
+    Recall is the fraction of the exact matcher's node changes that the LSH matcher reproduces identically (a node
+    change depends on the node matched, hence a lower recall means that the LSH matcher lost some of the exact matches).
+    """
+    print("bands\trows\tmatch_ms\tcost_evaluations\tmatch_cost\trecall")
+    with tempfile.TemporaryDirectory() as out_dir:
+        exact_changes = None
+        for bands, rows in [(None, None)] + configurations:
+            extra_args = [] if bands is None else ["--lsh-candidates", "--lsh-bands", str(bands), "--lsh-rows", str(rows)]
+            match_times = []
+            for _ in range(repeats):
+                diff, stats = run_timed_diff(nd_ancestor_fp, nd_version_fp, out_dir, extra_args=extra_args)
+                match_times.append(node_matching_time(stats))
+            changes = node_changes(diff)
+            if exact_changes is None:
+                exact_changes = changes
+            recall = len(changes & exact_changes) / len(exact_changes) if exact_changes else 1.0
+            print(f"{bands or 'exact'}\t{rows or '-'}\t{statistics.median(match_times):.1f}\t"
+                  f"{node_cost_evaluations(stats)}\t{final_node_match_cost(stats):.3f}\t{recall:.3f}")
+
+def parse_configuration(configuration):
+    """
+    Parses a "<bands>x<rows>" LSH configuration.
+    """
+    bands, rows = configuration.split("x")
+    return int(bands), int(rows)
+
+def main():
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument("ancestor", type=str, help="NodeDiff's ancestor script (json)")
+    parser.add_argument("version", type=str, help="NodeDiff's version script (json)")
+    parser.add_argument("-c", "--configurations", type=parse_configuration, nargs="+",
+                        help="LSH configurations as <bands>x<rows> (e.g. 32x8)",
+                        default=[(64, 8), (32, 8), (16, 8), (16, 4)])
+    parser.add_argument("-r", "--repeats", type=int, help="Number of runs for each configuration", default=5)
+    parser.add_argument("--nd-exec", type=str, help="Path to the nd_blender executable", default=None)
+
+    parsed = parser.parse_args()
+    if parsed.nd_exec is not None:
+        matching_scaling.ND_BLENDER_EXEC_PATH = parsed.nd_exec
+
+    run_lsh_benchmark(parsed.ancestor, parsed.version, parsed.configurations, parsed.repeats)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,46 @@
+import argparse
+import json
+
+
+# engine names, indexed by the values of nd::match_engine
+ENGINES = ["scan", "heap", "optimal", "anchor", "propagation", "beam"]
+
+def match_calls(stats_fp):
+    """
+    Returns the statistics of the matching calls (match_graphs and match_nodes) stored in a diff statistics file.
+    """
+    with open(stats_fp) as stats_file:
+        return json.load(stats_file).get("match_calls", [])
+
+def print_profile(stats_fps, top):
+    """
+    Prints the matching calls of the given diff statistics files, the slowest first: for each call its sizes, wall
+    time, cost evaluations, early exits and zero cost shortcuts, followed by the breakdown of its passes.
+    """
+    calls = [(stats_fp, call) for stats_fp in stats_fps for call in match_calls(stats_fp)]
+    calls.sort(key=lambda c: c[1]["wall_time"], reverse=True)
+
+    print("stats\tfunction\tancestor_size\tversion_size\tmatchings\twall_ms\tcost_evaluations\tearly_exits\t"
+          "zero_cost_shortcuts")
+    for stats_fp, call in calls[:top]:
+        print(f"{stats_fp}\t{call['function']}\t{call['ancestor_size']}\t{call['version_size']}\t"
+              f"{call['matchings']}\t{call['wall_time']:.1f}\t{call['cost_evaluations']}\t{call['early_exits']}\t"
+              f"{call['zero_cost_shortcuts']}")
+        for pass_idx, match_pass in enumerate(call.get("passes", [])):
+            print(f"\tpass {pass_idx} ({ENGINES[match_pass['engine']]})\titerations {match_pass['iterations']}\t"
+                  f"matches {match_pass['matches']}\t{match_pass['time']:.1f} ms\t"
+                  f"cost_evaluations {match_pass['cost_evaluations']}\tearly_exits {match_pass['early_exits']}\t"
+                  f"cache_hits {match_pass['cost_cache_hits']}")
+
+def main():
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument("stats", type=str, nargs="+", help="Diff statistics files (--stats option of the diff command)")
+    parser.add_argument("-n", "--top", type=int, help="Number of matching calls to print", default=10)
+
+    parsed = parser.parse_args()
+    print_profile(parsed.stats, parsed.top)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,97 @@
+import argparse
+import os
+import statistics
+import subprocess
+import tempfile
+
+import matching_scaling
+from matching_scaling import run_timed_diff, node_matching_time
+
+# Compared matchings: <name, diff command arguments> pairs
+MATCHINGS = [
+    ("greedy", []),
+    ("optimal", ["--optimal-matching"]),
+    ("beam4", ["--beam-width", "4"]),
+    ("structural", ["--structural-anchoring"]),
+    ("propagation", ["--similarity-propagation"]),
+    ("structural+propagation", ["--structural-anchoring", "--similarity-propagation"]),
+    ("spatial", ["--spatial-candidates"]),
+    ("lsh", ["--lsh-candidates"]),
+    ("hierarchical", ["--hierarchical-matching"]),
+]
+
+
+def parse_preset(preset_name, blender_preset_fp, nd_script_fp):
+    """
+    Parses a NodeKit's Blender preset and saves it as a serialized nd::script object.
+    """
+    command = [matching_scaling.ND_BLENDER_EXEC_PATH, "parse", preset_name, blender_preset_fp, "-o", nd_script_fp]
+    subprocess.run(command, stdout=subprocess.DEVNULL, check=True)
+
+def final_node_match_cost(stats):
+    """
+    Returns the total matching cost of the nodes (sum of edit costs of matched nodes, plus the number of unmatched
+    nodes), evaluated once all the matches are known, given the statistics of a diff.
+    """
+    return sum(match["final_match_cost"] for match in stats["matches"] if "node_ref" in match["match_type"])
+
+def diff_size(diff):
+    """
+    Returns a tuple (node_changes, property_changes) containing the number of added/deleted/edited nodes and the number
+    of properties changed by edited nodes (added/deleted nodes count as one property change), given a diff.
+    """
+    node_changes, property_changes = 0, 0
+    for graph_change in diff.values():
+        if graph_change["operation"] != "edit":
+            continue
+        for node_change in graph_change["diff"].values():
+            node_changes += 1
+            if node_change["operation"] == "edit":
+                property_changes += sum(len(properties) for properties in node_change["diff"].values())
+            else:
+                property_changes += 1
+    return node_changes, property_changes
+
+def run_quality_benchmark(preset_dirs, repeats):
+    """
+    For each preset directory (i.e. containing Ancestor/bl_ancestor.json and VersionN/bl_version.json NodeKit's Blender
+    presets) diffs the ancestor against each version, using each of the MATCHINGS. It prints node matching time (median
+    over repeats runs), final node matching cost and diff size for all of them.
+    """
+    print("preset\tversion\tmatching\tmatch_ms\tmatch_cost\tnode_changes\tproperty_changes")
+    with tempfile.TemporaryDirectory() as out_dir:
+        for preset_dir in preset_dirs:
+            preset_name = os.path.basename(os.path.normpath(preset_dir))
+            nd_ancestor_fp = os.path.join(out_dir, "nd_ancestor.json")
+            parse_preset(preset_name, os.path.join(preset_dir, "Ancestor", "bl_ancestor.json"), nd_ancestor_fp)
+
+            versions = sorted(d for d in os.listdir(preset_dir) if d.startswith("Version"))
+            for version in versions:
+                nd_version_fp = os.path.join(out_dir, "nd_version.json")
+                parse_preset(preset_name, os.path.join(preset_dir, version, "bl_version.json"), nd_version_fp)
+
+                for matching, extra_args in MATCHINGS:
+                    match_times = []
+                    for _ in range(repeats):
+                        diff, stats = run_timed_diff(nd_ancestor_fp, nd_version_fp, out_dir, extra_args=extra_args)
+                        match_times.append(node_matching_time(stats))
+                    node_changes, property_changes = diff_size(diff)
+                    print(f"{preset_name}\t{version}\t{matching}\t{statistics.median(match_times):.1f}\t"
+                          f"{final_node_match_cost(stats):.3f}\t{node_changes}\t{property_changes}")
+
+def main():
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument("presets", type=str, nargs="+", help="Preset directories (e.g. ./test/Kiwi)")
+    parser.add_argument("-r", "--repeats", type=int, help="Number of runs for each diff", default=5)
+    parser.add_argument("--nd-exec", type=str, help="Path to the nd_blender executable", default=None)
+
+    parsed = parser.parse_args()
+    if parsed.nd_exec is not None:
+        matching_scaling.ND_BLENDER_EXEC_PATH = parsed.nd_exec
+
+    run_quality_benchmark(parsed.presets, parsed.repeats)
+
+
+if __name__ == "__main__":
+    main()
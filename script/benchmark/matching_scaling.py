@@ -0,0 +1,90 @@
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import tempfile
+
+
+# default nd_blender executable path
+ND_BLENDER_EXEC_PATH = "./bin/nd_blender"
+
+def run_timed_diff(nd_ancestor_fp, nd_version_fp, out_dir, threads=None, extra_args=None):
+    """
+    Executes the nd_blender's differ and collects its statistics (nd_blender MUST be compiled with "-DND_STATISTICS_ENABLED").
+
+    Parameters:
+    - nd_ancestor_fp: filepath of the file containing the serialized ancestor nd::script object to diff.
+    - nd_version_fp: filepath of the file containing the serialized version nd::script object to diff.
+    - out_dir: directory in which to store the diff and the statistics obtained.
+    - threads: number of cores the differ is allowed to run on (*). If this parameter is not set, all the cores are used.
+    - extra_args: list of extra arguments passed to the diff command.
+
+    Returns: a tuple (diff, statistics) containing the parsed diff and statistics json files.
+
+    (*) Cores are limited by setting the process CPU affinity (Linux only), which is respected by the STL parallel algorithms' backend.
+    """
+    diff_fp = os.path.join(out_dir, "nd_diff.json")
+    stats_fp = os.path.join(out_dir, "stats.json")
+    command = [ND_BLENDER_EXEC_PATH, "diff", nd_ancestor_fp, nd_version_fp, "-o", diff_fp, "-s", stats_fp]
+    if extra_args is not None:
+        command += extra_args
+
+    preexec_fn = None
+    if threads is not None:
+        assert type(threads) == type(1) and threads > 0, "invalid number of threads"
+        preexec_fn = lambda: os.sched_setaffinity(0, range(threads))
+
+    subprocess.run(command, stdout=subprocess.DEVNULL, preexec_fn=preexec_fn, check=True)
+    with open(diff_fp) as diff_file, open(stats_fp) as stats_file:
+        return json.load(diff_file), json.load(stats_file)
+
+def node_matching_time(stats):
+    """
+    Returns the total time (ms) spent matching nodes, given the statistics of a diff.
+    """
+    return sum(match["time"] for match in stats["matches"] if "node_ref" in match["match_type"])
+
+def run_scaling_benchmark(nd_ancestor_fp, nd_version_fp, max_threads, repeats):
+    """
+    Diffs the same pair of nd::script objects using from 1 to max_threads cores, and prints node matching time,
+    total diff time and speedup (medians over repeats runs) for each number of cores.
+    It also checks that the diff obtained does not depend on the number of cores used.
+    """
+    print("threads\tmatch_ms\tdiff_ms\tspeedup\tsame_diff")
+    reference_diff = None
+    reference_time = None
+    with tempfile.TemporaryDirectory() as out_dir:
+        for threads in range(1, max_threads + 1):
+            match_times, diff_times = [], []
+            for _ in range(repeats):
+                diff, stats = run_timed_diff(nd_ancestor_fp, nd_version_fp, out_dir, threads)
+                match_times.append(node_matching_time(stats))
+                diff_times.append(stats["diff"]["time"])
+            if reference_diff is None:
+                reference_diff = diff
+                reference_time = statistics.median(diff_times)
+
+            diff_time = statistics.median(diff_times)
+            speedup = reference_time / diff_time if diff_time > 0 else float("nan")
+            print(f"{threads}\t{statistics.median(match_times):.1f}\t{diff_time:.1f}\t{speedup:.2f}\t{diff == reference_diff}")
+
+def main():
+    global ND_BLENDER_EXEC_PATH
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument("ancestor", type=str, help="NodeDiff's ancestor script (json)")
+    parser.add_argument("version", type=str, help="NodeDiff's version script (json)")
+    parser.add_argument("-t", "--max-threads", type=int, help="Maximum number of cores to use", default=len(os.sched_getaffinity(0)))
+    parser.add_argument("-r", "--repeats", type=int, help="Number of runs for each number of cores", default=5)
+    parser.add_argument("--nd-exec", type=str, help="Path to the nd_blender executable", default=None)
+
+    parsed = parser.parse_args()
+    if parsed.nd_exec is not None:
+        ND_BLENDER_EXEC_PATH = parsed.nd_exec
+
+    run_scaling_benchmark(parsed.ancestor, parsed.version, parsed.max_threads, parsed.repeats)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+/*
+ * Benchmark of the memory taken by nodes and of the throughput of copying them, given a NodeDiff's script (json).
+ * Memory is measured as the heap memory in use (glibc's mallinfo2, hence the benchmark runs on Linux only) after
+ * deserializing the script, minus the one in use before.
+ */
+#include <nodediff/script.h>
+#include <nodediff/utility/utility.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <malloc.h>
+#include <string>
+#include <vector>
+
+using namespace nd;
+
+static size_t heap_in_use() { return mallinfo2().uordblks; }
+
+// Milliseconds elapsed since the given time point (nd::timer only has a resolution of milliseconds)
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, const char** argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: value_benchmark <nd_script.json> [repeats]" << std::endl;
+		return 1;
+	}
+	const int repeats = argc > 2 ? std::stoi(argv[2]) : 10;
+	json script_json;
+	if (!load_json(argv[1], script_json))
+	{
+		std::cerr << "Failed to load json at: " << argv[1] << std::endl;
+		return 1;
+	}
+
+	// Memory per node
+	const size_t heap_before = heap_in_use();
+	script script			 = script_json.get<nd::script>();
+	const size_t heap_after	 = heap_in_use();
+	size_t nodes = 0, values = 0;
+	for (const auto& [graph_id, graph] : script.graphs)
+	{
+		nodes += graph.nodes.size();
+		for (const auto& [node_id, node] : graph.nodes)
+		{
+			values += node.node_values.size();
+		}
+	}
+	std::cout << "sizeof(value)\t" << sizeof(value) << " B" << std::endl;
+	std::cout << "nodes\t" << nodes << std::endl;
+	std::cout << "values\t" << values << std::endl;
+	std::cout << "memory_per_node\t" << static_cast<double>(heap_after - heap_before) / nodes << " B" << std::endl;
+
+	// Copy throughput of whole scripts and of values alone (medians over repeats)
+	auto median = [](std::vector<double>& times) {
+		std::sort(times.begin(), times.end());
+		return times[times.size() / 2];
+	};
+	std::vector<double> script_times, value_times;
+	for (int repeat = 0; repeat < repeats; ++repeat)
+	{
+		auto script_start = std::chrono::steady_clock::now();
+		nd::script copy	  = script;
+		script_times.push_back(milliseconds_since(script_start));
+
+		std::vector<value> value_copies;
+		value_copies.reserve(values);
+		auto value_start = std::chrono::steady_clock::now();
+		for (const auto& [graph_id, graph] : script.graphs)
+		{
+			for (const auto& [node_id, node] : graph.nodes)
+			{
+				for (const auto& [property_name, value] : node.node_values)
+				{
+					value_copies.push_back(value);
+				}
+			}
+		}
+		value_times.push_back(milliseconds_since(value_start));
+	}
+	std::cout << "script_copy\t" << median(script_times) << " ms\t" << nodes / median(script_times) * 1000
+			  << " nodes/s" << std::endl;
+	std::cout << "value_copy\t" << median(value_times) << " ms\t" << values / median(value_times) * 1000
+			  << " values/s" << std::endl;
+	return 0;
+}